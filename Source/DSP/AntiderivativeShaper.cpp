@@ -0,0 +1,274 @@
+#include "AntiderivativeShaper.h"
+#include "FastTanh.h"
+
+namespace
+{
+    // Below this input difference the divided differences are ill-conditioned
+    // and the midpoint fallbacks are used instead. Single precision loses the
+    // difference of two antiderivatives sooner, so its threshold is wider.
+    template <typename FloatType> constexpr FloatType tolerance = FloatType(1.0e-5);
+    template <> constexpr float tolerance<float> = 2.0e-3f;
+
+    constexpr double ln2 = 0.69314718055994530942;
+    constexpr double piSquaredOver12 = 0.82246703342411321824;
+
+    inline float shapeTanh(float u) noexcept   { return FastTanh::tanh(u); }
+    inline double shapeTanh(double u) noexcept { return std::tanh(u); }
+
+    // log(cosh(u)) without overflow for large |u|
+    inline double logCosh(double u) noexcept
+    {
+        const double a = std::abs(u);
+        return a + std::log1p(std::exp(-2.0 * a)) - ln2;
+    }
+
+    // log1p(exp(-2a)) for a >= 0, the correction term of logCosh, as a cubic
+    // Hermite table. The slopes are exact, so the interpolant is smooth
+    // enough for the divided difference that divides it by a small delta.
+    // Past the last entry the term is below 2e-8 and is dropped.
+    class LogCoshCorrection
+    {
+    public:
+        LogCoshCorrection() noexcept
+        {
+            for (int i = 0; i <= size; ++i)
+            {
+                const double a = i / pointsPerUnit;
+                const double e = std::exp(-2.0 * a);
+                values[i] = static_cast<float>(std::log1p(e));
+                slopes[i] = static_cast<float>(-2.0 * e / (1.0 + e) / pointsPerUnit);
+            }
+        }
+
+        float operator()(float a) const noexcept
+        {
+            const float position = a * static_cast<float>(pointsPerUnit);
+
+            if (position >= static_cast<float>(size))
+                return 0.0f;
+
+            const int i = static_cast<int>(position);
+            const float t = position - static_cast<float>(i);
+            const float d = values[i + 1] - values[i];
+
+            return values[i] + t * (slopes[i] + t * (3.0f * d - 2.0f * slopes[i] - slopes[i + 1]
+                                                     + t * (slopes[i] + slopes[i + 1] - 2.0f * d)));
+        }
+
+    private:
+        static constexpr double pointsPerUnit = 32.0;
+        static constexpr int size = 288;
+
+        float values[size + 1];
+        float slopes[size + 1];
+    };
+
+    const LogCoshCorrection logCoshCorrection;
+
+    inline float logCosh(float u) noexcept
+    {
+        const float a = std::abs(u);
+        return a + logCoshCorrection(a) - static_cast<float>(ln2);
+    }
+
+    // Dilogarithm Li2(x) for x in [-1, 0]. Maps to y = x / (x - 1) in [0, 1/2]
+    // and sums the Bernoulli series in u = -log(1 - y), which converges fast there.
+    inline double dilogNegative(double x) noexcept
+    {
+        const double y = x / (x - 1.0);
+        const double u = -std::log1p(-y);
+        const double u2 = u * u;
+
+        const double series = u * (1.0 + u * (-0.25 + u * (1.0 / 36.0
+                            + u2 * (-1.0 / 3600.0 + u2 * (1.0 / 211680.0
+                            + u2 * (-1.0 / 10886400.0 + u2 * (1.0 / 526901760.0
+                            + u2 * (-4.0647616451442256e-11 + u2 * 8.921691020456452e-13))))))));
+
+        const double l = std::log1p(-x);
+        return -series - 0.5 * l * l;
+    }
+
+    // Integral of log(cosh(t)) from 0 to u
+    inline double logCoshIntegral(double u) noexcept
+    {
+        const double a = std::abs(u);
+        const double value = 0.5 * a * a - a * ln2
+                           + 0.5 * (dilogNegative(-std::exp(-2.0 * a)) + piSquaredOver12);
+        return u < 0.0 ? -value : value;
+    }
+
+    // f(x) = tanh(drive * (x + asymmetry * |x| / 2)) - asymmetry * |x| / 4,
+    // i.e. tanh(k x) - (asymmetry / 4) |x| with a different slope k for each sign
+    template <typename FloatType>
+    struct AsymmetricTanhStage
+    {
+        AsymmetricTanhStage(FloatType drive, FloatType asymmetry) noexcept
+            : positiveSlope(drive * (FloatType(1) + FloatType(0.5) * asymmetry)),
+              negativeSlope(drive * (FloatType(1) - FloatType(0.5) * asymmetry)),
+              asymmetry(asymmetry)
+        {
+        }
+
+        FloatType slopeFor(FloatType x) const noexcept { return x >= FloatType(0) ? positiveSlope : negativeSlope; }
+
+        FloatType function(FloatType x) const noexcept
+        {
+            return shapeTanh(slopeFor(x) * x) - FloatType(0.25) * asymmetry * std::abs(x);
+        }
+
+        FloatType firstAntiderivative(FloatType x) const noexcept
+        {
+            const FloatType k = slopeFor(x);
+            return logCosh(k * x) / k - FloatType(0.125) * asymmetry * x * std::abs(x);
+        }
+
+        FloatType secondAntiderivative(FloatType x) const noexcept
+        {
+            const FloatType k = slopeFor(x);
+            return logCoshIntegral(k * x) / (k * k) - (asymmetry / FloatType(24)) * x * x * std::abs(x);
+        }
+
+        FloatType positiveSlope, negativeSlope, asymmetry;
+    };
+
+    // g(y) = y + 0.2a T2(y) + 0.15a T3(y) + 0.1a T4(y) on [-1, 1], held constant outside
+    template <typename FloatType>
+    struct ChebyshevStage
+    {
+        explicit ChebyshevStage(FloatType amount) noexcept
+        {
+            const FloatType a2 = amount * FloatType(0.2);
+            const FloatType a3 = amount * FloatType(0.15);
+            const FloatType a4 = amount * FloatType(0.1);
+
+            c[0] = a4 - a2;
+            c[1] = FloatType(1) - FloatType(3) * a3;
+            c[2] = FloatType(2) * a2 - FloatType(8) * a4;
+            c[3] = FloatType(4) * a3;
+            c[4] = FloatType(8) * a4;
+        }
+
+        FloatType polynomial(FloatType y) const noexcept
+        {
+            return c[0] + y * (c[1] + y * (c[2] + y * (c[3] + y * c[4])));
+        }
+
+        FloatType polynomialFirst(FloatType y) const noexcept
+        {
+            return y * (c[0] + y * (c[1] / 2 + y * (c[2] / 3 + y * (c[3] / 4 + y * c[4] / 5))));
+        }
+
+        FloatType polynomialSecond(FloatType y) const noexcept
+        {
+            return y * y * (c[0] / 2 + y * (c[1] / 6 + y * (c[2] / 12 + y * (c[3] / 20 + y * c[4] / 30))));
+        }
+
+        FloatType function(FloatType y) const noexcept
+        {
+            return polynomial(juce::jlimit(FloatType(-1), FloatType(1), y));
+        }
+
+        FloatType firstAntiderivative(FloatType y) const noexcept
+        {
+            if (std::abs(y) <= FloatType(1))
+                return polynomialFirst(y);
+
+            const FloatType edge = y > FloatType(0) ? FloatType(1) : FloatType(-1);
+            return polynomialFirst(edge) + polynomial(edge) * (y - edge);
+        }
+
+        FloatType secondAntiderivative(FloatType y) const noexcept
+        {
+            if (std::abs(y) <= FloatType(1))
+                return polynomialSecond(y);
+
+            const FloatType edge = y > FloatType(0) ? FloatType(1) : FloatType(-1);
+            const FloatType d = y - edge;
+            return polynomialSecond(edge) + polynomialFirst(edge) * d + FloatType(0.5) * polynomial(edge) * d * d;
+        }
+
+        FloatType c[5];
+    };
+}
+
+void AntiderivativeShaper::setOrder(Order newOrder)
+{
+    if (order != newOrder)
+    {
+        order = newOrder;
+        reset();
+    }
+}
+
+void AntiderivativeShaper::reset()
+{
+    tanhFirstOrderState = {};
+    chebyshevFirstOrderState = {};
+    tanhState = {};
+    chebyshevState = {};
+}
+
+template <typename Stage>
+float AntiderivativeShaper::processFirstOrder(FirstOrderState& state, const Stage& stage, float x) noexcept
+{
+    const float delta = x - state.x1;
+
+    const float y = std::abs(delta) < tolerance<float>
+                  ? stage.function(0.5f * (x + state.x1))
+                  : (stage.firstAntiderivative(x) - stage.firstAntiderivative(state.x1)) / delta;
+
+    state.x1 = x;
+    return y;
+}
+
+template <typename Stage>
+double AntiderivativeShaper::processSecondOrder(StageState& state, const Stage& stage, double x) noexcept
+{
+    const double delta = x - state.x1;
+
+    const double difference = std::abs(delta) < tolerance<double>
+                            ? stage.firstAntiderivative(0.5 * (x + state.x1))
+                            : (stage.secondAntiderivative(x) - stage.secondAntiderivative(state.x1)) / delta;
+
+    double y;
+
+    if (std::abs(x - state.x2) < tolerance<double>)
+    {
+        // x[n] and x[n-2] coincide: expand around their midpoint
+        const double xBar = 0.5 * (x + state.x2);
+        const double offset = xBar - state.x1;
+
+        if (std::abs(offset) < tolerance<double>)
+            y = stage.function(0.5 * (xBar + state.x1));
+        else
+            y = (2.0 / offset) * (stage.firstAntiderivative(xBar)
+                                  + (stage.secondAntiderivative(state.x1) - stage.secondAntiderivative(xBar)) / offset);
+    }
+    else
+    {
+        y = 2.0 * (difference - state.previousDifference) / (x - state.x2);
+    }
+
+    state.previousDifference = difference;
+    state.x2 = state.x1;
+    state.x1 = x;
+    return y;
+}
+
+float AntiderivativeShaper::processSample(float x, float drive, float asymmetry, float amount) noexcept
+{
+    if (order == Order::first)
+    {
+        const AsymmetricTanhStage<float> tanhStage(drive, asymmetry);
+        const ChebyshevStage<float> chebyshevStage(amount);
+
+        const float shaped = processFirstOrder(tanhFirstOrderState, tanhStage, x);
+        return processFirstOrder(chebyshevFirstOrderState, chebyshevStage, shaped);
+    }
+
+    const AsymmetricTanhStage<double> tanhStage(drive, asymmetry);
+    const ChebyshevStage<double> chebyshevStage(amount);
+
+    const double shaped = processSecondOrder(tanhState, tanhStage, x);
+    return static_cast<float>(processSecondOrder(chebyshevState, chebyshevStage, shaped));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Antiderivative anti-aliasing (ADAA) version of the HarmonicProcessor shaper:
+// asymmetric tanh followed by the clamped Chebyshev mix. Each stage is
+// evaluated through its closed-form first and second antiderivatives instead
+// of running at an oversampled rate.
+//
+// Latency is half a sample per stage for first order and one sample per stage
+// for second order; getLatencyInSamples() reports the total for both stages.
+//
+// First order runs in single precision: log(cosh) comes from a small Hermite
+// table and the near-constant input fallback uses FastTanh. Second order
+// keeps double precision for its nested divided differences and is several
+// times dearer; like ADAA as a whole, it is a quality option, and the
+// oversampled shaper stays the default.
+class AntiderivativeShaper
+{
+public:
+    enum class Order { first = 1, second = 2 };
+
+    AntiderivativeShaper() = default;
+
+    void setOrder(Order newOrder);
+    Order getOrder() const noexcept { return order; }
+
+    int getLatencyInSamples() const noexcept { return order == Order::first ? 1 : 2; }
+
+    void reset();
+
+    // Same parameters as HarmonicProcessor::asymmetricTanh and chebyshevMix
+    float processSample(float x, float drive, float asymmetry, float amount) noexcept;
+
+private:
+    // History for one first-order ADAA stage
+    struct FirstOrderState
+    {
+        float x1 { 0.0f };
+    };
+
+    // History for one second-order ADAA stage
+    struct StageState
+    {
+        double x1 { 0.0 };
+        double x2 { 0.0 };
+        double previousDifference { 0.0 };
+    };
+
+    Order order { Order::first };
+
+    FirstOrderState tanhFirstOrderState;
+    FirstOrderState chebyshevFirstOrderState;
+    StageState tanhState;
+    StageState chebyshevState;
+
+    template <typename Stage>
+    static float processFirstOrder(FirstOrderState& state, const Stage& stage, float x) noexcept;
+
+    template <typename Stage>
+    static double processSecondOrder(StageState& state, const Stage& stage, double x) noexcept;
+};
@@ -0,0 +1,128 @@
+#include "FastTanh.h"
+
+#if defined(__AVX__)
+ #include <immintrin.h>
+ #define SPREADSHEETS_TANH_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define SPREADSHEETS_TANH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define SPREADSHEETS_TANH_NEON 1
+#endif
+
+namespace
+{
+#if SPREADSHEETS_TANH_AVX
+    constexpr int vectorWidth = 8;
+
+    inline __m256 polynomial(__m256 x2, std::initializer_list<float> coefficients) noexcept
+    {
+        auto it = coefficients.begin();
+        __m256 result = _mm256_set1_ps(*it++);
+        for (; it != coefficients.end(); ++it)
+            result = _mm256_add_ps(_mm256_mul_ps(result, x2), _mm256_set1_ps(*it));
+        return result;
+    }
+#elif SPREADSHEETS_TANH_SSE2
+    constexpr int vectorWidth = 4;
+
+    inline __m128 polynomial(__m128 x2, std::initializer_list<float> coefficients) noexcept
+    {
+        auto it = coefficients.begin();
+        __m128 result = _mm_set1_ps(*it++);
+        for (; it != coefficients.end(); ++it)
+            result = _mm_add_ps(_mm_mul_ps(result, x2), _mm_set1_ps(*it));
+        return result;
+    }
+#elif SPREADSHEETS_TANH_NEON
+    constexpr int vectorWidth = 4;
+
+    inline float32x4_t polynomial(float32x4_t x2, std::initializer_list<float> coefficients) noexcept
+    {
+        auto it = coefficients.begin();
+        float32x4_t result = vdupq_n_f32(*it++);
+        for (; it != coefficients.end(); ++it)
+            result = vmlaq_f32(vdupq_n_f32(*it), result, x2);
+        return result;
+    }
+
+    inline float32x4_t divide(float32x4_t numerator, float32x4_t denominator) noexcept
+    {
+       #if defined(__aarch64__) || defined(_M_ARM64)
+        return vdivq_f32(numerator, denominator);
+       #else
+        // Reciprocal estimate refined by two Newton-Raphson steps
+        float32x4_t reciprocal = vrecpeq_f32(denominator);
+        reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+        reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+        return vmulq_f32(numerator, reciprocal);
+       #endif
+    }
+#endif
+}
+
+void FastTanh::shapeTanh(float* data, int numSamples, float drive, float outputGain) noexcept
+{
+    shapeTanh(data, data, numSamples, drive, outputGain);
+}
+
+void FastTanh::shapeTanh(float* dest, const float* src, int numSamples,
+                         float drive, float outputGain) noexcept
+{
+    int i = 0;
+
+#if SPREADSHEETS_TANH_AVX
+    const __m256 driveV = _mm256_set1_ps(drive);
+    const __m256 gainV = _mm256_set1_ps(outputGain);
+    const __m256 lo = _mm256_set1_ps(-clampLimit);
+    const __m256 hi = _mm256_set1_ps(clampLimit);
+
+    for (; i + vectorWidth <= numSamples; i += vectorWidth)
+    {
+        __m256 x = _mm256_mul_ps(_mm256_loadu_ps(src + i), driveV);
+        x = _mm256_max_ps(lo, _mm256_min_ps(hi, x));
+        const __m256 x2 = _mm256_mul_ps(x, x);
+
+        const __m256 p = polynomial(x2, { alpha13, alpha11, alpha9, alpha7, alpha5, alpha3, alpha1 });
+        const __m256 q = polynomial(x2, { beta6, beta4, beta2, beta0 });
+
+        _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_div_ps(_mm256_mul_ps(x, p), q), gainV));
+    }
+#elif SPREADSHEETS_TANH_SSE2
+    const __m128 driveV = _mm_set1_ps(drive);
+    const __m128 gainV = _mm_set1_ps(outputGain);
+    const __m128 lo = _mm_set1_ps(-clampLimit);
+    const __m128 hi = _mm_set1_ps(clampLimit);
+
+    for (; i + vectorWidth <= numSamples; i += vectorWidth)
+    {
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(src + i), driveV);
+        x = _mm_max_ps(lo, _mm_min_ps(hi, x));
+        const __m128 x2 = _mm_mul_ps(x, x);
+
+        const __m128 p = polynomial(x2, { alpha13, alpha11, alpha9, alpha7, alpha5, alpha3, alpha1 });
+        const __m128 q = polynomial(x2, { beta6, beta4, beta2, beta0 });
+
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_div_ps(_mm_mul_ps(x, p), q), gainV));
+    }
+#elif SPREADSHEETS_TANH_NEON
+    const float32x4_t lo = vdupq_n_f32(-clampLimit);
+    const float32x4_t hi = vdupq_n_f32(clampLimit);
+
+    for (; i + vectorWidth <= numSamples; i += vectorWidth)
+    {
+        float32x4_t x = vmulq_n_f32(vld1q_f32(src + i), drive);
+        x = vmaxq_f32(lo, vminq_f32(hi, x));
+        const float32x4_t x2 = vmulq_f32(x, x);
+
+        const float32x4_t p = polynomial(x2, { alpha13, alpha11, alpha9, alpha7, alpha5, alpha3, alpha1 });
+        const float32x4_t q = polynomial(x2, { beta6, beta4, beta2, beta0 });
+
+        vst1q_f32(dest + i, vmulq_n_f32(divide(vmulq_f32(x, p), q), outputGain));
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+        dest[i] = tanh(src[i] * drive) * outputGain;
+}
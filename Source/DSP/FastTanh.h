@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Rational tanh approximation and FloatVectorOperations-style block kernels.
+//
+// tanh(x) ~= x * P(x^2) / Q(x^2) with P of degree 6 and Q of degree 3 in x^2,
+// evaluated on x clamped to +/-7.9053 (beyond which float tanh rounds to +/-1).
+// Maximum absolute error against std::tanh is below 4e-7 over the whole float
+// range, and the result never leaves [-1, 1].
+//
+// Block kernels use AVX, SSE2 or NEON when the target supports them and fall
+// back to the scalar form for the remainder.
+class FastTanh
+{
+public:
+    static inline float tanh(float x) noexcept
+    {
+        x = juce::jlimit(-clampLimit, clampLimit, x);
+        const float x2 = x * x;
+
+        float p = alpha13;
+        p = p * x2 + alpha11;
+        p = p * x2 + alpha9;
+        p = p * x2 + alpha7;
+        p = p * x2 + alpha5;
+        p = p * x2 + alpha3;
+        p = p * x2 + alpha1;
+
+        float q = beta6;
+        q = q * x2 + beta4;
+        q = q * x2 + beta2;
+        q = q * x2 + beta0;
+
+        return x * p / q;
+    }
+
+    // data[i] = tanh(data[i] * drive) * outputGain
+    static void shapeTanh(float* data, int numSamples, float drive, float outputGain = 1.0f) noexcept;
+
+    // dest[i] = tanh(src[i] * drive) * outputGain
+    static void shapeTanh(float* dest, const float* src, int numSamples,
+                          float drive, float outputGain = 1.0f) noexcept;
+
+private:
+    static constexpr float clampLimit = 7.90531110763549805f;
+
+    static constexpr float alpha1 = 4.89352455891786e-03f;
+    static constexpr float alpha3 = 6.37261928875436e-04f;
+    static constexpr float alpha5 = 1.48572235717979e-05f;
+    static constexpr float alpha7 = 5.12229709037114e-08f;
+    static constexpr float alpha9 = -8.60467152213735e-11f;
+    static constexpr float alpha11 = 2.00018790482477e-13f;
+    static constexpr float alpha13 = -2.76076847742355e-16f;
+
+    static constexpr float beta0 = 4.89352518554385e-03f;
+    static constexpr float beta2 = 2.26843463243900e-03f;
+    static constexpr float beta4 = 1.18534705686654e-04f;
+    static constexpr float beta6 = 1.19825839466702e-06f;
+
+    FastTanh() = delete;
+};
@@ -0,0 +1,112 @@
+#include "PartitionedConvolver.h"
+
+// ConvolutionSpectra Implementation
+ConvolutionSpectra::ConvolutionSpectra(int size, const float* impulse, int numSamples)
+    : partitionSize(size)
+{
+    jassert(juce::isPowerOfTwo(partitionSize));
+
+    numPartitions = juce::jmax(1, (numSamples + partitionSize - 1) / partitionSize);
+
+    const int fftSize = partitionSize * 2;
+    const int numBins = partitionSize + 1;
+    juce::dsp::FFT fft(juce::roundToInt(std::log2(fftSize)));
+    std::vector<float> buffer(static_cast<size_t>(fftSize * 2));
+
+    spectra.resize(static_cast<size_t>(numPartitions * numBins * 2));
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        // Each partition is zero-padded to the transform size
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+
+        const int start = partition * partitionSize;
+        const int length = juce::jlimit(0, partitionSize, numSamples - start);
+        std::copy(impulse + start, impulse + start + length, buffer.begin());
+
+        fft.performRealOnlyForwardTransform(buffer.data(), true);
+        std::copy(buffer.begin(), buffer.begin() + numBins * 2,
+                  spectra.begin() + partition * numBins * 2);
+    }
+}
+
+const float* ConvolutionSpectra::getPartition(int index) const noexcept
+{
+    jassert(index >= 0 && index < numPartitions);
+    return spectra.data() + index * (partitionSize + 1) * 2;
+}
+
+// PartitionedConvolver Implementation
+void PartitionedConvolver::prepare(int size, int newMaxPartitions)
+{
+    jassert(juce::isPowerOfTwo(size) && newMaxPartitions > 0);
+
+    partitionSize = size;
+    numBins = partitionSize + 1;
+    maxPartitions = newMaxPartitions;
+
+    const int fftSize = partitionSize * 2;
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(fftSize)));
+
+    fftBuffer.assign(static_cast<size_t>(fftSize * 2), 0.0f);
+    previousInput.assign(static_cast<size_t>(partitionSize), 0.0f);
+    delayLine.assign(static_cast<size_t>(maxPartitions * numBins * 2), 0.0f);
+    accumulator.assign(static_cast<size_t>(numBins * 2), 0.0f);
+
+    reset();
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    std::fill(previousInput.begin(), previousInput.end(), 0.0f);
+    std::fill(delayLine.begin(), delayLine.end(), 0.0f);
+    delayLinePosition = 0;
+}
+
+void PartitionedConvolver::processBlock(const float* input, float* output,
+                                        const ConvolutionSpectra& spectra) noexcept
+{
+    jassert(spectra.getPartitionSize() == partitionSize);
+
+    const int spectrumSize = numBins * 2;
+
+    // Overlap-save window: previous block followed by this one
+    float* fftData = fftBuffer.data();
+    std::copy(previousInput.begin(), previousInput.end(), fftData);
+    std::copy(input, input + partitionSize, fftData + partitionSize);
+    std::copy(input, input + partitionSize, previousInput.begin());
+
+    fft->performRealOnlyForwardTransform(fftData, true);
+
+    float* newestSpectrum = delayLine.data() + delayLinePosition * spectrumSize;
+    std::copy(fftData, fftData + spectrumSize, newestSpectrum);
+
+    // Multiply-accumulate: input spectrum k blocks old against partition k
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    float* acc = accumulator.data();
+
+    const int numPartitions = juce::jmin(spectra.getNumPartitions(), maxPartitions);
+    int slot = delayLinePosition;
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const float* x = delayLine.data() + slot * spectrumSize;
+        const float* h = spectra.getPartition(partition);
+
+        for (int bin = 0; bin < spectrumSize; bin += 2)
+        {
+            acc[bin]     += x[bin] * h[bin]     - x[bin + 1] * h[bin + 1];
+            acc[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+        }
+
+        slot = slot == 0 ? maxPartitions - 1 : slot - 1;
+    }
+
+    std::copy(accumulator.begin(), accumulator.end(), fftData);
+    fft->performRealOnlyInverseTransform(fftData);
+
+    // The second half of the window is free of circular wrap-around
+    std::copy(fftData + partitionSize, fftData + partitionSize * 2, output);
+
+    delayLinePosition = delayLinePosition + 1 == maxPartitions ? 0 : delayLinePosition + 1;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Frequency-domain partitions of one segment of an impulse response, ready
+// for uniformly partitioned overlap-save convolution in blocks of
+// partitionSize samples. Built off the audio thread.
+class ConvolutionSpectra
+{
+public:
+    ConvolutionSpectra(int partitionSize, const float* impulse, int numSamples);
+
+    int getPartitionSize() const noexcept { return partitionSize; }
+    int getNumPartitions() const noexcept { return numPartitions; }
+
+    // Interleaved re/im pairs for bins 0..partitionSize of one partition
+    const float* getPartition(int index) const noexcept;
+
+private:
+    int partitionSize { 0 };
+    int numPartitions { 0 };
+    std::vector<float> spectra;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionSpectra)
+};
+
+// One level of uniformly partitioned overlap-save convolution (UPOLS): each
+// block of partitionSize input samples is transformed once, kept in a
+// frequency-domain delay line, and multiplied against every partition of the
+// impulse. All storage is reserved in prepare().
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver() = default;
+
+    void prepare(int partitionSize, int maxPartitions);
+    void reset() noexcept;
+
+    int getPartitionSize() const noexcept { return partitionSize; }
+
+    // Convolves one block of partitionSize samples and overwrites output with
+    // the matching partitionSize output samples. Partitions beyond the
+    // prepared maximum are ignored.
+    void processBlock(const float* input, float* output, const ConvolutionSpectra& spectra) noexcept;
+
+private:
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int partitionSize { 0 };
+    int numBins { 0 };
+    int maxPartitions { 0 };
+
+    std::vector<float> fftBuffer;        // 2 * fftSize floats, as juce::dsp::FFT requires
+    std::vector<float> previousInput;    // the previous block: the first half of each transform
+    std::vector<float> delayLine;        // maxPartitions input spectra, interleaved re/im
+    std::vector<float> accumulator;      // numBins complex values
+    int delayLinePosition { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
@@ -0,0 +1,34 @@
+#include "QuadratureOscillator.h"
+
+void QuadratureOscillator::prepare(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    setFrequency(frequency);
+    reset();
+}
+
+void QuadratureOscillator::setFrequency(float newFrequency) noexcept
+{
+    frequency = newFrequency;
+
+    const double increment = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    rotationSin = static_cast<float>(std::sin(increment));
+    rotationCos = static_cast<float>(std::cos(increment));
+}
+
+void QuadratureOscillator::setPhase(float phaseInRadians) noexcept
+{
+    sine = std::sin(phaseInRadians);
+    cosine = std::cos(phaseInRadians);
+    samplesSinceRenormalise = 0;
+}
+
+void QuadratureOscillator::renormalise() noexcept
+{
+    // The magnitude only drifts by a few ulps between calls, so one Newton
+    // step of 1/sqrt around 1 is exact enough: g = (3 - |z|^2) / 2
+    const float gain = 1.5f - 0.5f * (sine * sine + cosine * cosine);
+    sine *= gain;
+    cosine *= gain;
+    samplesSinceRenormalise = 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Sine/cosine pair generated by rotating a unit phasor: each sample is one
+// complex multiply by e^(i * 2pi * f / fs), so there is no per-sample trig
+// or phase wrapping. The rotation is only recomputed when the frequency
+// changes, and the phasor's magnitude is pulled back to 1 every
+// renormaliseInterval samples to cancel float rounding drift.
+class QuadratureOscillator
+{
+public:
+    QuadratureOscillator() = default;
+
+    void prepare(double sampleRate) noexcept;
+
+    void setFrequency(float newFrequency) noexcept;
+    float getFrequency() const noexcept { return frequency; }
+
+    // Sets the current phase in radians; sin() then returns sin(phase)
+    void setPhase(float phaseInRadians) noexcept;
+    void reset() noexcept { setPhase(0.0f); }
+
+    float sin() const noexcept { return sine; }
+    float cos() const noexcept { return cosine; }
+
+    // Moves the phasor forward by one sample
+    inline void advance() noexcept
+    {
+        const float nextCosine = cosine * rotationCos - sine * rotationSin;
+        sine = sine * rotationCos + cosine * rotationSin;
+        cosine = nextCosine;
+
+        if (++samplesSinceRenormalise >= renormaliseInterval)
+            renormalise();
+    }
+
+private:
+    static constexpr int renormaliseInterval = 64;
+
+    double sampleRate { 44100.0 };
+    float frequency { 0.0f };
+
+    float sine { 0.0f };
+    float cosine { 1.0f };
+    float rotationSin { 0.0f };
+    float rotationCos { 1.0f };
+    int samplesSinceRenormalise { 0 };
+
+    void renormalise() noexcept;
+};
@@ -0,0 +1,18 @@
+#include "ScratchArena.h"
+
+void ScratchArena::prepare(int newNumBuffers, int newMaxSamples)
+{
+    jassert(newNumBuffers > 0 && newMaxSamples > 0);
+
+    numBuffers = newNumBuffers;
+    maxSamples = newMaxSamples;
+    stride = ((maxSamples + alignmentInFloats - 1) / alignmentInFloats) * alignmentInFloats;
+
+    storage.calloc(static_cast<size_t>(numBuffers * stride));
+}
+
+float* ScratchArena::getBuffer(int index) noexcept
+{
+    jassert(index >= 0 && index < numBuffers);
+    return storage.get() + index * stride;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Fixed pool of float scratch buffers for audio-thread processing.
+// All memory is reserved in prepare(); getBuffer() never allocates.
+class ScratchArena
+{
+public:
+    ScratchArena() = default;
+
+    void prepare(int numBuffers, int maxSamples);
+
+    float* getBuffer(int index) noexcept;
+
+    int getNumBuffers() const noexcept { return numBuffers; }
+    int getMaxSamples() const noexcept { return maxSamples; }
+
+private:
+    // Pad each buffer to a multiple of 64 bytes so buffers never share a cache line
+    static constexpr int alignmentInFloats = 16;
+
+    juce::HeapBlock<float> storage;
+    int numBuffers { 0 };
+    int maxSamples { 0 };
+    int stride { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScratchArena)
+};
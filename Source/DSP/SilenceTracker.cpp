@@ -0,0 +1,38 @@
+#include "SilenceTracker.h"
+
+bool SilenceTracker::isSilent(const juce::AudioBuffer<float>& buffer) noexcept
+{
+    if (buffer.hasBeenCleared())
+        return true;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) >= silenceThreshold)
+            return false;
+
+    return true;
+}
+
+void SilenceTracker::setTailLength(juce::int64 newTailSamples) noexcept
+{
+    const bool wasIdle = isIdle();
+    tailSamples = newTailSamples;
+
+    if (wasIdle)
+        silentSamples = juce::jmax(silentSamples, tailSamples);
+}
+
+bool SilenceTracker::update(bool inputIsSilent, int numSamples) noexcept
+{
+    if (!inputIsSilent)
+    {
+        silentSamples = 0;
+        return true;
+    }
+
+    if (isIdle())
+        return false;
+
+    // Still ringing out; this block counts towards the tail
+    silentSamples += numSamples;
+    return true;
+}
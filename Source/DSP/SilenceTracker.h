@@ -0,0 +1,33 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Decides when a processing stage can sleep. A stage stays awake while its
+// input carries signal and for its tail length after the input falls
+// silent; once the tail has played out, its process call can be skipped.
+class SilenceTracker
+{
+public:
+    // -90 dBFS
+    static constexpr float silenceThreshold = 3.1622777e-5f;
+
+    SilenceTracker() = default;
+
+    // True when every channel is flagged clear or peaks below the threshold
+    static bool isSilent(const juce::AudioBuffer<float>& buffer) noexcept;
+
+    // A stage that has already rung out stays asleep when its tail grows
+    void setTailLength(juce::int64 newTailSamples) noexcept;
+
+    // Registers one block; returns true while the stage still has to run
+    bool update(bool inputIsSilent, int numSamples) noexcept;
+
+    bool isIdle() const noexcept { return silentSamples >= tailSamples; }
+
+    // Puts the stage to sleep, e.g. after a reset has cleared its state
+    void sleep() noexcept { silentSamples = tailSamples; }
+
+private:
+    juce::int64 tailSamples { 0 };
+    juce::int64 silentSamples { 0 };
+};
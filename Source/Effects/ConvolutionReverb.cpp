@@ -0,0 +1,525 @@
+#include "ConvolutionReverb.h"
+
+namespace
+{
+    // Scales an impulse to unit energy so decay and file changes keep a steady level
+    void normaliseEnergy(juce::AudioBuffer<float>& impulse)
+    {
+        double energy = 0.0;
+        const float* data = impulse.getReadPointer(0);
+
+        for (int i = 0; i < impulse.getNumSamples(); ++i)
+            energy += static_cast<double>(data[i]) * data[i];
+
+        if (energy > 0.0)
+            impulse.applyGain(static_cast<float>(1.0 / std::sqrt(energy)));
+    }
+}
+
+// ReverbImpulse Implementation
+ReverbImpulse::ReverbImpulse(const float* impulse, int numSamples, double sr,
+                             int newHeadBlockSize, int newTailBlockSize)
+    : sampleRate(sr),
+      headBlockSize(newHeadBlockSize),
+      tailBlockSize(newTailBlockSize),
+      lengthSeconds(numSamples / sr),
+      head(newHeadBlockSize, impulse, juce::jmin(numSamples, newTailBlockSize * 2)),
+      tail(newTailBlockSize, impulse + juce::jmin(numSamples, newTailBlockSize * 2),
+           juce::jmax(0, numSamples - newTailBlockSize * 2))
+{
+}
+
+juce::AudioBuffer<float> ReverbImpulse::generate(float decaySeconds, double sr, double maxSeconds)
+{
+    // RT60 envelope, cut off where it has fallen by 90 dB
+    const double decay = juce::jmax(0.05, static_cast<double>(decaySeconds));
+    const int length = juce::jmax(1, static_cast<int>(juce::jmin(decay * 1.5, maxSeconds) * sr));
+    const double decayRate = std::log(1000.0) / (decay * sr);
+    const int fadeInLength = juce::jmax(1, static_cast<int>(0.005 * sr));
+
+    juce::AudioBuffer<float> impulse(1, length);
+    float* data = impulse.getWritePointer(0);
+
+    juce::Random random(0x303);
+    const double nyquist = 0.49 * sr;
+    double damped = 0.0;
+
+    for (int i = 0; i < length; ++i)
+    {
+        // Damping: a one-pole lowpass that closes from 12 kHz to 1.5 kHz over the decay
+        const double progress = juce::jmin(1.0, i / (decay * sr));
+        const double cutoff = juce::jmin(nyquist, 12000.0 * std::pow(1500.0 / 12000.0, progress));
+        const double pole = std::exp(-juce::MathConstants<double>::twoPi * cutoff / sr);
+
+        const double noise = random.nextFloat() * 2.0 - 1.0;
+        damped = noise + pole * (damped - noise);
+
+        const double fadeIn = juce::jmin(1.0, static_cast<double>(i) / fadeInLength);
+        data[i] = static_cast<float>(damped * std::exp(-decayRate * i) * fadeIn);
+    }
+
+    normaliseEnergy(impulse);
+    return impulse;
+}
+
+juce::AudioBuffer<float> ReverbImpulse::load(const juce::File& file, double sr, double maxSeconds)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+        return {};
+
+    const int fileLength = static_cast<int>(juce::jmin(reader->lengthInSamples,
+        static_cast<juce::int64>(maxSeconds * reader->sampleRate)));
+    const int fileChannels = static_cast<int>(reader->numChannels);
+
+    juce::AudioBuffer<float> source(fileChannels, fileLength);
+    reader->read(&source, 0, fileLength, 0, true, true);
+
+    for (int channel = 1; channel < fileChannels; ++channel)
+        source.addFrom(0, 0, source, channel, 0, fileLength);
+
+    source.applyGain(0, 0, fileLength, 1.0f / static_cast<float>(fileChannels));
+
+    const double ratio = reader->sampleRate / sr;
+    const int length = juce::jmax(1, static_cast<int>(fileLength / ratio));
+
+    juce::AudioBuffer<float> impulse(1, length);
+    impulse.clear();
+
+    if (ratio == 1.0)
+    {
+        impulse.copyFrom(0, 0, source, 0, 0, juce::jmin(length, fileLength));
+    }
+    else
+    {
+        // The interpolator reads a few samples past the end, so give it zero padding
+        source.setSize(1, fileLength + 8, true, true);
+        juce::LagrangeInterpolator interpolator;
+        interpolator.process(ratio, source.getReadPointer(0), impulse.getWritePointer(0), length);
+    }
+
+    normaliseEnergy(impulse);
+    return impulse;
+}
+
+// Convolves posted tail blocks and carries out reset requests. Polls rather
+// than waiting on an event, so the audio thread never has to signal it.
+class ConvolutionReverb::TailWorker : public juce::Thread
+{
+public:
+    explicit TailWorker(ConvolutionReverb& owner)
+        : juce::Thread("Reverb Tail"), reverb(owner)
+    {
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            const auto resetRequest = reverb.requestedTailResets.load(std::memory_order_acquire);
+
+            if (resetRequest != reverb.completedTailResets.load(std::memory_order_relaxed))
+            {
+                reverb.resetTail();
+                reverb.completedTailResets.store(resetRequest, std::memory_order_release);
+            }
+            else if (reverb.completedTailBlocks.load(std::memory_order_acquire)
+                     < reverb.postedTailBlocks.load(std::memory_order_acquire))
+            {
+                reverb.convolveTail();
+                reverb.completedTailBlocks.fetch_add(1, std::memory_order_release);
+            }
+            else
+            {
+                wait(1);
+            }
+        }
+    }
+
+private:
+    ConvolutionReverb& reverb;
+};
+
+// Builds impulses off the audio thread and deletes the ones the audio thread retires
+class ConvolutionReverb::ImpulseBuilder : public juce::Thread
+{
+public:
+    ImpulseBuilder(ConvolutionReverb& owner, float initialDecay)
+        : juce::Thread("Reverb Impulse"), reverb(owner), builtDecay(initialDecay)
+    {
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            delete reverb.retiredImpulse.exchange(nullptr, std::memory_order_acquire);
+
+            const float decay = reverb.requestedDecay.load(std::memory_order_relaxed);
+            juce::File file;
+            int fileRequest;
+
+            {
+                const juce::ScopedLock lock(reverb.fileLock);
+                file = reverb.requestedFile;
+                fileRequest = reverb.fileRequestCount;
+            }
+
+            const bool fileChanged = fileRequest != builtFileRequest;
+            const bool decayChanged = file == juce::File() && decay != builtDecay;
+
+            if (fileChanged || decayChanged)
+            {
+                build(file, decay);
+                builtFileRequest = fileRequest;
+                builtDecay = decay;
+            }
+
+            wait(50);
+        }
+    }
+
+private:
+    ConvolutionReverb& reverb;
+    float builtDecay;
+    int builtFileRequest { 0 };
+
+    void build(const juce::File& file, float decay)
+    {
+        juce::AudioBuffer<float> impulse;
+
+        if (file != juce::File())
+            impulse = ReverbImpulse::load(file, reverb.sampleRate, maxImpulseSeconds);
+
+        // A file that fails to load falls back to the generated impulse
+        if (impulse.getNumSamples() == 0)
+            impulse = ReverbImpulse::generate(decay, reverb.sampleRate, maxImpulseSeconds);
+
+        auto* prepared = new ReverbImpulse(impulse.getReadPointer(0), impulse.getNumSamples(),
+                                           reverb.sampleRate, reverb.headBlockSize, reverb.tailBlockSize);
+
+        // Replaces an impulse the audio thread has not picked up yet
+        delete reverb.pendingImpulse.exchange(prepared, std::memory_order_acq_rel);
+    }
+};
+
+// ConvolutionReverb Implementation
+ConvolutionReverb::ConvolutionReverb()
+{
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    stopThreads();
+    delete pendingImpulse.exchange(nullptr);
+    delete retiredImpulse.exchange(nullptr);
+}
+
+void ConvolutionReverb::prepare(double sr, int newNumChannels, int requestedHeadBlockSize)
+{
+    jassert(newNumChannels > 0 && newNumChannels <= maxChannels);
+
+    stopThreads();
+    delete pendingImpulse.exchange(nullptr);
+    delete retiredImpulse.exchange(nullptr);
+
+    sampleRate = sr;
+    numChannels = juce::jlimit(1, maxChannels, newNumChannels);
+    headBlockSize = juce::nextPowerOfTwo(juce::jmax(1, requestedHeadBlockSize));
+    tailBlockSize = juce::jmax(minTailBlockSize, headBlockSize * tailBlocksPerHeadBlock);
+
+    const int headLength = tailBlockSize * 2;
+    const int maxImpulseSamples = static_cast<int>(std::ceil(maxImpulseSeconds * sampleRate));
+    const int maxTailPartitions = juce::jmax(1, (maxImpulseSamples - headLength + tailBlockSize - 1) / tailBlockSize);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        headConvolvers[channel].prepare(headBlockSize, headLength / headBlockSize);
+        tailConvolvers[channel].prepare(tailBlockSize, maxTailPartitions);
+    }
+
+    headInput.setSize(numChannels, headBlockSize);
+    headOutput.setSize(numChannels, headBlockSize);
+    tailInput[0].setSize(numChannels, tailBlockSize);
+    tailInput[1].setSize(numChannels, tailBlockSize);
+    tailOutput.setSize(numChannels, tailBlockSize);
+
+    // Room for a head block and a whole tail block ahead of the read position
+    const int ringSize = juce::nextPowerOfTwo(tailBlockSize + headBlockSize * 2);
+    wetRing.setSize(numChannels, ringSize);
+    wetMask = ringSize - 1;
+
+    // The first impulse is built here so playback never starts without one
+    const float decay = requestedDecay.load(std::memory_order_relaxed);
+    auto impulse = ReverbImpulse::generate(decay, sampleRate, maxImpulseSeconds);
+    currentImpulse = std::make_unique<ReverbImpulse>(impulse.getReadPointer(0), impulse.getNumSamples(),
+                                                     sampleRate, headBlockSize, tailBlockSize);
+    updateTailLength();
+
+    mix.reset(sampleRate, mixRampSeconds);
+    postedTailBlocks.store(0, std::memory_order_relaxed);
+    completedTailBlocks.store(0, std::memory_order_relaxed);
+    reset();
+
+    tailWorker = std::make_unique<TailWorker>(*this);
+    impulseBuilder = std::make_unique<ImpulseBuilder>(*this, decay);
+    tailWorker->startThread(juce::Thread::Priority::high);
+    impulseBuilder->startThread(juce::Thread::Priority::low);
+}
+
+void ConvolutionReverb::reset() noexcept
+{
+    if (numChannels == 0)
+        return;
+
+    // The head is small enough to clear here; the tail belongs to the worker
+    for (int channel = 0; channel < numChannels; ++channel)
+        headConvolvers[channel].reset();
+
+    headInput.clear();
+    wetRing.clear();
+    headFill = 0;
+    wetReadPosition = 0;
+
+    tailResetPending = true;
+    requestedTailResets.fetch_add(1, std::memory_order_release);
+
+    // Without a worker (prepare, or audio running before it started) clear the tail here
+    if (tailWorker == nullptr || !tailWorker->isThreadRunning())
+    {
+        resetTail();
+        completedTailResets.store(requestedTailResets.load(std::memory_order_relaxed),
+                                  std::memory_order_release);
+    }
+
+    collectTailReset();
+}
+
+void ConvolutionReverb::resetTail() noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        tailConvolvers[channel].reset();
+
+    tailOutput.clear();
+
+    // Blocks posted before the reset are dropped rather than convolved
+    completedTailBlocks.store(postedTailBlocks.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+bool ConvolutionReverb::collectTailReset() noexcept
+{
+    if (!tailResetPending)
+        return true;
+
+    if (completedTailResets.load(std::memory_order_acquire)
+        != requestedTailResets.load(std::memory_order_relaxed))
+        return false;
+
+    // Block k sits in slot k % 2, so the next block starts in the slot matching the count
+    tailSlot = static_cast<int>(postedTailBlocks.load(std::memory_order_relaxed) & 1);
+    tailFill = 0;
+    tailResetPending = false;
+    return true;
+}
+
+void ConvolutionReverb::loadImpulseResponse(const juce::File& file)
+{
+    const juce::ScopedLock lock(fileLock);
+    requestedFile = file;
+    ++fileRequestCount;
+}
+
+void ConvolutionReverb::stopThreads()
+{
+    if (tailWorker != nullptr)
+        tailWorker->stopThread(1000);
+
+    if (impulseBuilder != nullptr)
+        impulseBuilder->stopThread(5000);
+
+    tailWorker.reset();
+    impulseBuilder.reset();
+}
+
+void ConvolutionReverb::convolveTail() noexcept
+{
+    // Block k sits in slot k % 2; the audio thread is filling the other one
+    const int slot = static_cast<int>(completedTailBlocks.load(std::memory_order_relaxed) & 1);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        tailConvolvers[channel].processBlock(tailInput[slot].getReadPointer(channel),
+                                             tailOutput.getWritePointer(channel),
+                                             currentImpulse->tail);
+}
+
+void ConvolutionReverb::waitForTail() noexcept
+{
+    const auto posted = postedTailBlocks.load(std::memory_order_relaxed);
+
+    while (completedTailBlocks.load(std::memory_order_acquire) < posted)
+    {
+        // Without a worker (audio running before prepare finished starting it) do the work here
+        if (tailWorker == nullptr || !tailWorker->isThreadRunning())
+        {
+            convolveTail();
+            completedTailBlocks.fetch_add(1, std::memory_order_release);
+            continue;
+        }
+
+        juce::Thread::yield();
+    }
+}
+
+void ConvolutionReverb::finishTailBlock() noexcept
+{
+    // The previous block's tail output starts exactly one head block from now
+    waitForTail();
+
+    if (postedTailBlocks.load(std::memory_order_relaxed) > 0)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* tail = tailOutput.getReadPointer(channel);
+            float* ring = wetRing.getWritePointer(channel);
+
+            for (int i = 0; i < tailBlockSize; ++i)
+                ring[(wetReadPosition + headBlockSize + i) & wetMask] += tail[i];
+        }
+    }
+
+    // The worker is idle, so this is the one point where the impulse can change
+    adoptPendingImpulse();
+
+    tailSlot ^= 1;
+    tailFill = 0;
+    postedTailBlocks.fetch_add(1, std::memory_order_release);
+}
+
+void ConvolutionReverb::adoptPendingImpulse() noexcept
+{
+    // Keep at most one retired impulse so the audio thread never deletes one
+    if (retiredImpulse.load(std::memory_order_acquire) != nullptr)
+        return;
+
+    auto* next = pendingImpulse.exchange(nullptr, std::memory_order_acq_rel);
+
+    if (next == nullptr)
+        return;
+
+    if (next->sampleRate != sampleRate || next->headBlockSize != headBlockSize
+        || next->tailBlockSize != tailBlockSize)
+    {
+        retiredImpulse.store(next, std::memory_order_release);
+        return;
+    }
+
+    retiredImpulse.store(currentImpulse.release(), std::memory_order_release);
+    currentImpulse.reset(next);
+    updateTailLength();
+}
+
+void ConvolutionReverb::updateTailLength() noexcept
+{
+    // The wet path runs one head block behind the input
+    tailLengthSeconds.store(currentImpulse->lengthSeconds + headBlockSize / sampleRate,
+                            std::memory_order_relaxed);
+}
+
+void ConvolutionReverb::process(juce::AudioBuffer<float>& buffer) noexcept
+{
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+
+    if (channels == 0 || numSamples == 0)
+        return;
+
+    // The mix ramps over mixRampSeconds, linearly across this block's share of it
+    const float startMix = mix.getCurrentValue();
+    mix.skip(numSamples);
+    const float endMix = mix.getCurrentValue();
+
+    // Until the worker has cleared the tail the wet signal is silent and nothing is fed in
+    if (!collectTailReset())
+    {
+        for (int channel = 0; channel < channels; ++channel)
+            buffer.applyGainRamp(channel, 0, numSamples, 1.0f - startMix, 1.0f - endMix);
+
+        return;
+    }
+
+    const float mixStep = (endMix - startMix) / static_cast<float>(numSamples);
+    float wetGain = startMix;
+
+    for (int position = 0; position < numSamples;)
+    {
+        const int todo = juce::jmin(numSamples - position, headBlockSize - headFill);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* headIn = headInput.getWritePointer(channel, headFill);
+            float* tailIn = tailInput[tailSlot].getWritePointer(channel, tailFill);
+            float* ring = wetRing.getWritePointer(channel);
+
+            // A mono buffer on a stereo reverb feeds the second channel silence
+            if (channel >= channels)
+            {
+                std::fill(headIn, headIn + todo, 0.0f);
+                std::fill(tailIn, tailIn + todo, 0.0f);
+
+                for (int i = 0; i < todo; ++i)
+                    ring[(wetReadPosition + i) & wetMask] = 0.0f;
+
+                continue;
+            }
+
+            float* data = buffer.getWritePointer(channel, position);
+            std::copy(data, data + todo, headIn);
+            std::copy(data, data + todo, tailIn);
+
+            float gain = wetGain;
+
+            for (int i = 0; i < todo; ++i)
+            {
+                const int readPosition = (wetReadPosition + i) & wetMask;
+                const float wet = ring[readPosition];
+                ring[readPosition] = 0.0f;
+
+                gain += mixStep;
+                data[i] += (wet - data[i]) * gain;
+            }
+        }
+
+        wetGain += mixStep * static_cast<float>(todo);
+        wetReadPosition = (wetReadPosition + todo) & wetMask;
+        headFill += todo;
+        tailFill += todo;
+        position += todo;
+
+        if (headFill < headBlockSize)
+            continue;
+
+        // A full head block lands right at the read position, one block after its input
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            headConvolvers[channel].processBlock(headInput.getReadPointer(channel),
+                                                 headOutput.getWritePointer(channel),
+                                                 currentImpulse->head);
+
+            const float* head = headOutput.getReadPointer(channel);
+            float* ring = wetRing.getWritePointer(channel);
+
+            for (int i = 0; i < headBlockSize; ++i)
+                ring[(wetReadPosition + i) & wetMask] += head[i];
+        }
+
+        headFill = 0;
+
+        if (tailFill == tailBlockSize)
+            finishTailBlock();
+    }
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../DSP/PartitionedConvolver.h"
+
+// Impulse response prepared for ConvolutionReverb: a head segment split into
+// small partitions for the audio callback and a tail segment split into
+// large partitions for the background worker. Built off the audio thread.
+struct ReverbImpulse
+{
+    ReverbImpulse(const float* impulse, int numSamples, double sampleRate,
+                  int headBlockSize, int tailBlockSize);
+
+    // Exponentially decaying, progressively darker noise; deterministic for a given decay
+    static juce::AudioBuffer<float> generate(float decaySeconds, double sampleRate, double maxSeconds);
+
+    // Reads an audio file, mixes it to mono and resamples it; empty on failure
+    static juce::AudioBuffer<float> load(const juce::File& file, double sampleRate, double maxSeconds);
+
+    double sampleRate;
+    int headBlockSize;
+    int tailBlockSize;
+    double lengthSeconds;
+
+    ConvolutionSpectra head;
+    ConvolutionSpectra tail;
+};
+
+// Non-uniformly partitioned convolution reverb with mono impulse responses.
+//
+// The first 2 * tailBlockSize samples of the impulse are convolved in the
+// audio callback in headBlockSize partitions. The rest is convolved on a
+// worker thread in tailBlockSize partitions. Every time tailBlockSize input
+// samples have been collected, the callback hands them to the worker. The
+// callback collects the worker's previous result one tail block later,
+// which is exactly when the tail starts contributing. The handoff points are
+// fixed, so the output never depends on thread timing. The callback only
+// waits if the worker has fallen a whole tail block behind.
+//
+// The wet signal is delayed by headBlockSize samples, a short pre-delay for
+// the reverb, so no plugin latency is needed.
+class ConvolutionReverb
+{
+public:
+    static constexpr double maxImpulseSeconds = 8.0;
+
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+
+    // headBlockSize is rounded up to a power of two. Call while audio is stopped.
+    void prepare(double sampleRate, int numChannels, int headBlockSize);
+
+    // Safe on the audio thread: the tail is cleared by the worker, and the wet
+    // signal stays silent until it has done so
+    void reset() noexcept;
+
+    void setMix(float newMix) noexcept { mix.setTargetValue(juce::jlimit(0.0f, 1.0f, newMix)); }
+    bool isFullyDry() const noexcept { return mix.getCurrentValue() == 0.0f && mix.getTargetValue() == 0.0f; }
+
+    // Regenerates the algorithmic impulse in the background; ignored while a file is loaded
+    void setDecay(float seconds) noexcept { requestedDecay.store(seconds, std::memory_order_relaxed); }
+
+    // Loads an impulse file in the background; an empty File returns to the generated impulse.
+    // Call from the message thread.
+    void loadImpulseResponse(const juce::File& file);
+
+    // Length of the impulse in use plus the processing delay; safe from any thread
+    double getTailLengthSeconds() const noexcept { return tailLengthSeconds.load(std::memory_order_relaxed); }
+
+    // Processes the first numChannels channels of the buffer in place
+    void process(juce::AudioBuffer<float>& buffer) noexcept;
+
+private:
+    static constexpr int maxChannels = 2;
+    static constexpr int minTailBlockSize = 1024;
+    static constexpr int tailBlocksPerHeadBlock = 16;
+    static constexpr double mixRampSeconds = 0.02;
+
+    double sampleRate { 44100.0 };
+    int numChannels { 0 };
+    int headBlockSize { 0 };
+    int tailBlockSize { 0 };
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> mix { 0.0f };
+
+    // Impulse handoff: the builder publishes into pendingImpulse, the audio
+    // thread swaps it in at a tail boundary and parks the old one in
+    // retiredImpulse for the builder to delete
+    std::unique_ptr<ReverbImpulse> currentImpulse;
+    std::atomic<ReverbImpulse*> pendingImpulse { nullptr };
+    std::atomic<ReverbImpulse*> retiredImpulse { nullptr };
+    std::atomic<double> tailLengthSeconds { 0.0 };
+
+    // Head: audio thread
+    PartitionedConvolver headConvolvers[maxChannels];
+    juce::AudioBuffer<float> headInput;
+    juce::AudioBuffer<float> headOutput;
+    int headFill { 0 };
+
+    // Wet output accumulator; head and tail blocks are added ahead of the read position
+    juce::AudioBuffer<float> wetRing;
+    int wetMask { 0 };
+    int wetReadPosition { 0 };
+
+    // Tail: filled by the audio thread, convolved by the worker
+    juce::AudioBuffer<float> tailInput[2];
+    juce::AudioBuffer<float> tailOutput;
+    PartitionedConvolver tailConvolvers[maxChannels];
+    int tailFill { 0 };
+    int tailSlot { 0 };
+    std::atomic<juce::int64> postedTailBlocks { 0 };
+    std::atomic<juce::int64> completedTailBlocks { 0 };
+
+    // Reset handshake: the audio thread bumps the request count, the worker
+    // clears the tail state it owns and matches it
+    std::atomic<juce::uint32> requestedTailResets { 0 };
+    std::atomic<juce::uint32> completedTailResets { 0 };
+    bool tailResetPending { false };
+
+    class TailWorker;
+    class ImpulseBuilder;
+    std::unique_ptr<TailWorker> tailWorker;
+    std::unique_ptr<ImpulseBuilder> impulseBuilder;
+
+    std::atomic<float> requestedDecay { 2.0f };
+
+    juce::CriticalSection fileLock;
+    juce::File requestedFile;
+    int fileRequestCount { 0 };
+
+    void stopThreads();
+    void convolveTail() noexcept;
+    void resetTail() noexcept;
+    bool collectTailReset() noexcept;
+    void waitForTail() noexcept;
+    void finishTailBlock() noexcept;
+    void adoptPendingImpulse() noexcept;
+    void updateTailLength() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
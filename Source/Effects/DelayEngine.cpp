@@ -0,0 +1,111 @@
+#include "DelayEngine.h"
+
+void DelayEngine::prepare(double sr, double maxDelaySeconds, int newNumChannels)
+{
+    jassert(newNumChannels > 0 && newNumChannels <= maxChannels);
+
+    sampleRate = sr;
+    numChannels = juce::jlimit(1, maxChannels, newNumChannels);
+
+    // Room for the longest delay plus the interpolation taps
+    maxDelaySamples = static_cast<float>(maxDelaySeconds * sampleRate);
+    const int lineLength = juce::nextPowerOfTwo(static_cast<int>(std::ceil(maxDelaySamples)) + 4);
+    bufferMask = lineLength - 1;
+
+    storage.calloc(static_cast<size_t>(lineLength * numChannels));
+    mix.reset(sampleRate, mixRampSeconds);
+
+    for (int channel = 0; channel < maxChannels; ++channel)
+        lines[channel] = channel < numChannels ? storage.get() + channel * lineLength : nullptr;
+
+    // Start at the requested time rather than gliding in from zero
+    delaySamples.reset(sampleRate, glideSeconds);
+    delaySamples.setCurrentAndTargetValue(juce::jlimit(minDelaySamples, maxDelaySamples,
+                                                       static_cast<float>(delaySeconds * sampleRate)));
+
+    reset();
+}
+
+void DelayEngine::reset() noexcept
+{
+    if (numChannels > 0)
+        std::fill(storage.get(), storage.get() + (bufferMask + 1) * numChannels, 0.0f);
+
+    writePosition = 0;
+    delaySamples.setCurrentAndTargetValue(delaySamples.getTargetValue());
+}
+
+void DelayEngine::setDelayTime(float seconds) noexcept
+{
+    delaySeconds = seconds;
+
+    if (numChannels == 0)
+        return;  // not prepared yet; prepare() picks the time up
+    delaySamples.setTargetValue(juce::jlimit(minDelaySamples, maxDelaySamples,
+                                             static_cast<float>(seconds * sampleRate)));
+}
+
+void DelayEngine::setDelayInSamples(double samples) noexcept
+{
+    // Synced times arrive in samples; the seconds are kept for a later prepare()
+    delaySeconds = samples / sampleRate;
+
+    if (numChannels == 0)
+        return;
+    delaySamples.setTargetValue(juce::jlimit(minDelaySamples, maxDelaySamples, static_cast<float>(samples)));
+}
+
+double DelayEngine::getTailLengthSeconds(float threshold) const noexcept
+{
+    // Repeat k leaves the line at feedback^(k-1); without feedback only the first one sounds
+    double repeats = 1.0;
+
+    if (feedback > threshold)
+        repeats += std::ceil(std::log(static_cast<double>(threshold)) / std::log(static_cast<double>(feedback)));
+
+    // The glide target is the time the engine is heading to, whichever setter chose it
+    const double seconds = numChannels > 0 ? static_cast<double>(delaySamples.getTargetValue()) / sampleRate
+                                           : delaySeconds;
+    return repeats * seconds;
+}
+
+void DelayEngine::process(juce::AudioBuffer<float>& buffer) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (numChannels > 1 && buffer.getNumChannels() > 1)
+        processFrames<2>(buffer.getArrayOfWritePointers(), numSamples);
+    else if (buffer.getNumChannels() > 0)
+        processFrames<1>(buffer.getArrayOfWritePointers(), numSamples);
+}
+
+template <int channels>
+void DelayEngine::processFrames(float* const* data, int numSamples) noexcept
+{
+    int position = writePosition;
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        const float delay = delaySamples.getNextValue();
+        const int wholeDelay = static_cast<int>(delay);
+        const float fraction = delay - static_cast<float>(wholeDelay);
+        const int readPosition = position - wholeDelay;
+        const float wetGain = mix.getNextValue();
+        const float dryGain = 1.0f - wetGain;
+
+        // channels is a compile-time constant, so this unrolls to straight-line code
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            float* line = lines[channel];
+            const float delayed = readHermite(line, bufferMask, readPosition, fraction);
+            const float input = data[channel][sample];
+
+            line[position] = input + delayed * feedback;
+            data[channel][sample] = input * dryGain + delayed * wetGain;
+        }
+
+        position = (position + 1) & bufferMask;
+    }
+
+    writePosition = position;
+}
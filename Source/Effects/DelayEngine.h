@@ -0,0 +1,71 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Feedback delay for up to two channels on a power-of-two ring buffer, so
+// every read and write index is wrapped with a mask instead of a modulo.
+// The delay time glides to its target and is read with 4-point Hermite
+// interpolation, so moving the time knob sweeps the pitch instead of
+// clicking. Both channels advance together in a single loop.
+class DelayEngine
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    DelayEngine() = default;
+
+    void prepare(double sampleRate, double maxDelaySeconds, int numChannels);
+    void reset() noexcept;
+
+    void setDelayTime(float seconds) noexcept;
+    void setDelayInSamples(double samples) noexcept;
+    void setFeedback(float newFeedback) noexcept { feedback = newFeedback; }
+    void setMix(float newMix) noexcept { mix.setTargetValue(newMix); }
+
+    // True once the mix has settled at zero, so processing would return the input unchanged
+    bool isFullyDry() const noexcept { return mix.getCurrentValue() == 0.0f && mix.getTargetValue() == 0.0f; }
+
+    // Time until the repeats of a single impulse fall below threshold
+    double getTailLengthSeconds(float threshold) const noexcept;
+
+    // Processes the first numChannels channels of the buffer in place
+    void process(juce::AudioBuffer<float>& buffer) noexcept;
+
+private:
+    static constexpr double glideSeconds = 0.08;
+    static constexpr double mixRampSeconds = 0.02;
+    static constexpr float minDelaySamples = 2.0f;  // keeps the Hermite taps behind the write head
+
+    double sampleRate { 44100.0 };
+    int numChannels { 0 };
+
+    juce::HeapBlock<float> storage;
+    float* lines[maxChannels] {};
+    int bufferMask { 0 };
+    int writePosition { 0 };
+
+    double delaySeconds { 0.375 };
+    float maxDelaySamples { 0.0f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> delaySamples;
+    float feedback { 0.5f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> mix { 0.3f };  // ramps across blocks
+
+    static inline float readHermite(const float* line, int mask, int position, float fraction) noexcept
+    {
+        // Taps at delays d-1, d, d+1, d+2 around the integer delay d
+        const float xm1 = line[(position + 1) & mask];
+        const float x0 = line[position & mask];
+        const float x1 = line[(position - 1) & mask];
+        const float x2 = line[(position - 2) & mask];
+
+        const float c1 = 0.5f * (x1 - xm1);
+        const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+        const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        return ((c3 * fraction + c2) * fraction + c1) * fraction + x0;
+    }
+
+    template <int channels>
+    void processFrames(float* const* data, int numSamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayEngine)
+};
@@ -0,0 +1,218 @@
+#include "EffectsPipeline.h"
+#include "../Utility/AllocationGuard.h"
+
+// Spins for a few microseconds after each block in case the next one is
+// already on its way, then sleeps until the audio thread posts one
+class EffectsPipeline::Worker : public juce::Thread
+{
+public:
+    explicit Worker(EffectsPipeline& owner)
+        : juce::Thread("Effects Pipeline"), pipeline(owner)
+    {
+    }
+
+    void run() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        const auto spinTicks = juce::Time::secondsToHighResolutionTicks(spinMicroseconds * 1.0e-6);
+
+        while (!threadShouldExit())
+        {
+            if (hasPostedBlock())
+            {
+                pipeline.runNextBlock();
+                continue;
+            }
+
+            const auto spinUntil = juce::Time::getHighResolutionTicks() + spinTicks;
+
+            while (!hasPostedBlock() && juce::Time::getHighResolutionTicks() < spinUntil)
+                juce::Thread::yield();
+
+            // A notify() that lands between the check and the wait is kept by
+            // the event, so a posted block is never slept through
+            if (!hasPostedBlock())
+                wait(-1);
+        }
+    }
+
+private:
+    static constexpr double spinMicroseconds = 5.0;
+
+    EffectsPipeline& pipeline;
+
+    bool hasPostedBlock() const noexcept
+    {
+        return pipeline.completedBlocks.load(std::memory_order_relaxed)
+               < pipeline.postedBlocks.load(std::memory_order_acquire);
+    }
+};
+
+// EffectsPipeline Implementation
+EffectsPipeline::EffectsPipeline(EffectsProcessor& effectsToRun)
+    : effects(effectsToRun)
+{
+}
+
+EffectsPipeline::~EffectsPipeline()
+{
+    release();
+}
+
+void EffectsPipeline::prepare(double sampleRate, int newNumChannels, int maxBlockSize)
+{
+    release();
+
+    numChannels = juce::jmax(1, newNumChannels);
+    latency = juce::jmax(1, maxBlockSize);
+
+    for (auto& slot : slots)
+    {
+        slot.audio.setSize(numChannels, latency);
+        slot.audio.clear();
+        slot.numSamples = 0;
+    }
+
+    // Holds the latency gap plus one block in flight
+    const int ringSize = juce::nextPowerOfTwo(latency * 2);
+    outputRing.setSize(numChannels, ringSize);
+    outputRing.clear();
+    outputMask = ringSize - 1;
+
+    postedBlocks.store(0, std::memory_order_relaxed);
+    completedBlocks.store(0, std::memory_order_relaxed);
+    collectedBlocks = 0;
+    xruns.store(0, std::memory_order_relaxed);
+    inputPosition = 0;
+    audibleUntil = 0;
+    outputIsSilent = true;
+
+    worker = std::make_unique<Worker>(*this);
+    worker->startRealtimeThread(juce::Thread::RealtimeOptions{}
+                                    .withApproximateAudioProcessingTime(latency, sampleRate));
+}
+
+void EffectsPipeline::release()
+{
+    if (worker != nullptr)
+        worker->stopThread(1000);
+
+    worker.reset();
+}
+
+void EffectsPipeline::process(juce::AudioBuffer<float>& buffer, double samplesPerStep,
+                              bool inputIsSilent) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+
+    jassert(numSamples <= latency);
+
+    if (numSamples == 0 || numSamples > latency)
+        return;
+
+    const auto blockIndex = postedBlocks.load(std::memory_order_relaxed);
+    const bool workerIsRunning = worker != nullptr && worker->isThreadRunning();
+
+    // Without a worker the pipeline still works, just without the overlap
+    if (!workerIsRunning && completedBlocks.load(std::memory_order_relaxed) < blockIndex)
+        runNextBlock();
+
+    if (completedBlocks.load(std::memory_order_acquire) < blockIndex)
+    {
+        // The worker still holds the previous block, and the slot this block
+        // would use is the one it may need next: drop the block rather than wait
+        xruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        if (collectedBlocks < blockIndex)
+        {
+            collect(slots[(blockIndex - 1) & 1]);
+            collectedBlocks = blockIndex;
+        }
+
+        // The worker is idle, so this block's slot can be filled
+        auto& slot = slots[blockIndex & 1];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if (channel < channels)
+                slot.audio.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+            else
+                slot.audio.clear(channel, 0, numSamples);
+        }
+
+        slot.numSamples = numSamples;
+        slot.samplesPerStep = samplesPerStep;
+        slot.inputIsSilent = inputIsSilent;
+        slot.position = inputPosition;
+
+        postedBlocks.store(blockIndex + 1, std::memory_order_release);
+
+        if (workerIsRunning)
+            worker->notify();
+        else
+            runNextBlock();
+    }
+
+    // Read this block's span of the output timeline and free it for reuse
+    const int readStart = static_cast<int>(inputPosition & outputMask);
+    const int firstPart = juce::jmin(numSamples, outputMask + 1 - readStart);
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        buffer.copyFrom(channel, 0, outputRing, channel, readStart, firstPart);
+        buffer.copyFrom(channel, firstPart, outputRing, channel, 0, numSamples - firstPart);
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        outputRing.clear(channel, readStart, firstPart);
+        outputRing.clear(channel, 0, numSamples - firstPart);
+    }
+
+    outputIsSilent = inputPosition >= audibleUntil;
+    inputPosition += numSamples;
+}
+
+void EffectsPipeline::runNextBlock() noexcept
+{
+    ScopedNoAllocationCheck noAllocations;
+
+    const auto blockIndex = completedBlocks.load(std::memory_order_relaxed);
+    auto& slot = slots[blockIndex & 1];
+
+    // A view of the slot's storage, using AudioBuffer's preallocated channel table
+    juce::AudioBuffer<float> block(slot.audio.getArrayOfWritePointers(), numChannels, slot.numSamples);
+
+    effects.updateParameters();
+    effects.setSamplesPerStep(slot.samplesPerStep);
+    effects.processBlock(block);
+
+    slot.outputIsSilent = slot.inputIsSilent && effects.isIdle();
+
+    completedBlocks.store(blockIndex + 1, std::memory_order_release);
+}
+
+void EffectsPipeline::collect(const Slot& slot) noexcept
+{
+    // The result lands exactly latency samples after its input. One collected
+    // after an xrun may already be partly behind the read position; that part
+    // has been played as silence and is skipped.
+    const juce::int64 outputPosition = slot.position + latency;
+    const int skipped = static_cast<int>(juce::jlimit((juce::int64) 0, (juce::int64) slot.numSamples,
+                                                      inputPosition - outputPosition));
+    const int numToWrite = slot.numSamples - skipped;
+    const int writeStart = static_cast<int>((outputPosition + skipped) & outputMask);
+    const int firstPart = juce::jmin(numToWrite, outputMask + 1 - writeStart);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        outputRing.copyFrom(channel, writeStart, slot.audio, channel, skipped, firstPart);
+        outputRing.copyFrom(channel, 0, slot.audio, channel, skipped + firstPart, numToWrite - firstPart);
+    }
+
+    if (!slot.outputIsSilent)
+        audibleUntil = juce::jmax(audibleUntil, outputPosition + slot.numSamples);
+}
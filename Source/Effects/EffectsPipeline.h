@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "EffectsProcessor.h"
+
+// Runs an EffectsProcessor on a real-time worker thread, one block behind
+// the audio callback, so the effects of block N overlap with the synth
+// rendering block N + 1.
+//
+// Each call hands the fresh block to the worker through one of two slots
+// and collects the worker's result for the previous block. Results are
+// written into an output ring exactly maxBlockSize samples after their
+// input, so the latency stays fixed when the host varies its block size.
+// A pair of atomic block counters carries the hand-over; the worker sleeps
+// on its WaitableEvent between blocks and the audio thread wakes it.
+//
+// The audio thread never waits. If the worker has not finished the previous
+// block, the fresh block is dropped and counted as an xrun: its span of the
+// output stays silent, and the late result is used for whatever part of it
+// is still ahead of the read position.
+//
+// While pipelined, the worker owns the EffectsProcessor: parameter updates
+// and the sequencer step length travel with each block.
+class EffectsPipeline
+{
+public:
+    explicit EffectsPipeline(EffectsProcessor& effectsToRun);
+    ~EffectsPipeline();
+
+    // Sizes the buffers and starts the worker. Call while audio is stopped.
+    void prepare(double sampleRate, int numChannels, int maxBlockSize);
+    void release();
+
+    // Latency added by the pipeline, in samples
+    int getLatencySamples() const noexcept { return latency; }
+
+    // Replaces the buffer with the effected signal from getLatencySamples() ago
+    void process(juce::AudioBuffer<float>& buffer, double samplesPerStep, bool inputIsSilent) noexcept;
+
+    // True when the block just returned by process() is silent: its input
+    // was silent and every effect had rung out
+    bool isOutputSilent() const noexcept { return outputIsSilent; }
+
+    // Blocks dropped because the worker was still busy with the one before;
+    // safe to call from any thread
+    int getNumXruns() const noexcept { return xruns.load(std::memory_order_relaxed); }
+
+private:
+    EffectsProcessor& effects;
+
+    class Worker;
+    std::unique_ptr<Worker> worker;
+
+    int numChannels { 0 };
+    int latency { 0 };
+
+    // Block k travels in slot k % 2
+    struct Slot
+    {
+        juce::AudioBuffer<float> audio;
+        int numSamples { 0 };
+        double samplesPerStep { 0.0 };
+        bool inputIsSilent { true };
+        bool outputIsSilent { true };
+        juce::int64 position { 0 };
+    };
+
+    Slot slots[2];
+    std::atomic<juce::int64> postedBlocks { 0 };
+    std::atomic<juce::int64> completedBlocks { 0 };
+    juce::int64 collectedBlocks { 0 };
+    std::atomic<int> xruns { 0 };
+
+    // Effected output, read latency samples behind the input position
+    juce::AudioBuffer<float> outputRing;
+    int outputMask { 0 };
+    juce::int64 inputPosition { 0 };
+    juce::int64 audibleUntil { 0 };
+    bool outputIsSilent { true };
+
+    void runNextBlock() noexcept;
+    void collect(const Slot& slot) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectsPipeline)
+};
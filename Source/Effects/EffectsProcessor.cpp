@@ -2,99 +2,297 @@
 
 EffectsProcessor::EffectsProcessor()
 {
+    for (int i = 0; i < numNodes; ++i)
+        nodes[static_cast<size_t>(i)].type = static_cast<NodeType>(i);
+
+    order = getOrder(0);
 }
 
 EffectsProcessor::~EffectsProcessor()
 {
 }
 
-void EffectsProcessor::prepareToPlay(double sr, int samplesPerBlock)
+void EffectsProcessor::prepareToPlay(double sr, int samplesPerBlock, int numChannels)
 {
     sampleRate = sr;
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+
+    delay.prepare(sampleRate, maxDelaySeconds, numChannels);
+    phaser.prepare(sampleRate, numChannels);
+    reverb.prepare(sampleRate, numChannels, reverbHeadBlockSize);
 
-    dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 2;
+    nodes[static_cast<size_t>(NodeType::phaser)].activity.setTailLength(
+        static_cast<juce::int64>(phaserTailSeconds * sampleRate));
+    updateTailLength();
 
-    effectsChain.prepare(spec);
+    // Every node starts from reset state, so none has anything to ring out
+    for (auto& node : nodes)
+    {
+        node.activity.sleep();
+        node.bypassed = isFullyDry(node.type);
+    }
 
-    auto& delay = effectsChain.get<delayIndex>();
-    delay.setMaximumDelayInSamples(static_cast<int>(sampleRate * 2.0));
+    nodeInput.setSize(numChannels, maxBlockSize);
+    orderGains.calloc(static_cast<size_t>(maxBlockSize));
 
-    delayBufferSize = static_cast<int>(sampleRate * 2.0);
-    delayBuffer.resize(delayBufferSize * 2);
-    std::fill(delayBuffer.begin(), delayBuffer.end(), 0.0f);
-    delayWritePosition = 0;
+    // Nothing is playing yet, so a pending reorder can take effect straight away
+    currentOrderIndex = requestedOrderIndex;
+    order = getOrder(currentOrderIndex);
+    orderGain.reset(sampleRate, orderFadeSeconds);
+    orderGain.setCurrentAndTargetValue(1.0f);
 
     // Comb filter removed - harmonics processing now in TB303Voice
-
-    dryBuffer.setSize(2, samplesPerBlock);
 }
 
 void EffectsProcessor::releaseResources()
 {
-    effectsChain.reset();
+    for (auto& node : nodes)
+    {
+        resetNode(node.type);
+        node.activity.sleep();
+    }
 }
 
-void EffectsProcessor::processBlock(juce::AudioBuffer<float>& buffer)
+bool EffectsProcessor::isIdle() const noexcept
 {
-    dryBuffer.makeCopyOf(buffer);
+    for (auto& node : nodes)
+        if (!node.bypassed && !node.activity.isIdle())
+            return false;
 
-    processDelay(buffer);
+    return true;
+}
 
-    dsp::AudioBlock<float> block(buffer);
-    dsp::ProcessContextReplacing<float> context(block);
+bool EffectsProcessor::isFullyDry(NodeType type) const noexcept
+{
+    switch (type)
+    {
+        case NodeType::delay:  return delay.isFullyDry();
+        case NodeType::phaser: return phaser.isFullyDry();
+        case NodeType::reverb: return reverb.isFullyDry();
+        default:               return true;
+    }
+}
 
-    auto& phaser = effectsChain.get<phaserIndex>();
-    phaser.process(context);
+void EffectsProcessor::processNode(Node& node, juce::AudioBuffer<float>& buffer) noexcept
+{
+    switch (node.type)
+    {
+        case NodeType::delay:  delay.process(buffer); break;
+        case NodeType::phaser: phaser.process(buffer); break;
+        case NodeType::reverb: reverb.process(buffer); break;
+        default:               break;
+    }
 }
 
-void EffectsProcessor::processDelay(juce::AudioBuffer<float>& buffer)
+void EffectsProcessor::processNodeFaded(Node& node, juce::AudioBuffer<float>& buffer) noexcept
 {
-    const int numChannels = buffer.getNumChannels();
     const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), nodeInput.getNumChannels());
 
-    int delaySamples = static_cast<int>(delayTime * sampleRate);
+    for (int channel = 0; channel < numChannels; ++channel)
+        nodeInput.copyFrom(channel, 0, buffer, channel, 0, numSamples);
 
+    processNode(node, buffer);
+
+    // Scale only what the node changed, so its input passes at full level
     for (int channel = 0; channel < numChannels; ++channel)
     {
-        float* channelData = buffer.getWritePointer(channel);
-        const float* dryData = dryBuffer.getReadPointer(channel);
+        const float* input = nodeInput.getReadPointer(channel);
+        float* output = buffer.getWritePointer(channel);
 
-        for (int sample = 0; sample < numSamples; ++sample)
+        for (int i = 0; i < numSamples; ++i)
+            output[i] = input[i] + (output[i] - input[i]) * orderGains[i];
+    }
+}
+
+void EffectsProcessor::resetNode(NodeType type) noexcept
+{
+    switch (type)
+    {
+        case NodeType::delay:  delay.reset(); break;
+        case NodeType::phaser: phaser.reset(); break;
+        case NodeType::reverb: reverb.reset(); break;
+        default:               break;
+    }
+}
+
+void EffectsProcessor::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    // The fade scratch holds maxBlockSize samples; a host that sends more is served in parts
+    if (maxBlockSize > 0 && numSamples > maxBlockSize)
+    {
+        for (int start = 0; start < numSamples; start += maxBlockSize)
         {
-            int delayReadPosition = (delayWritePosition - delaySamples + delayBufferSize) % delayBufferSize;
-            int bufferIndex = channel * delayBufferSize + delayReadPosition;
+            juce::AudioBuffer<float> part(buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                          start, juce::jmin(maxBlockSize, numSamples - start));
+            processBlock(part);
+        }
 
-            float delaySample = delayBuffer[bufferIndex];
+        return;
+    }
 
-            float inputWithFeedback = dryData[sample] + (delaySample * delayFeedback);
+    // A reorder starts by fading the nodes out; a newer request can turn a fade-in around
+    if (requestedOrderIndex != currentOrderIndex && orderGain.getTargetValue() == 1.0f)
+        orderGain.setTargetValue(0.0f);
 
-            int writeIndex = channel * delayBufferSize + delayWritePosition;
-            delayBuffer[writeIndex] = inputWithFeedback;
+    const bool fading = orderGain.isSmoothing() || orderGain.getCurrentValue() < 1.0f;
 
-            channelData[sample] = dryData[sample] * (1.0f - delayMix) + delaySample * delayMix;
+    if (fading)
+        for (int i = 0; i < numSamples; ++i)
+            orderGains[i] = orderGain.getNextValue();
+
+    // Each node hears silence only while the input and every awake node before it are quiet
+    bool inputIsSilent = SilenceTracker::isSilent(buffer);
+
+    for (auto nodeIndex : order)
+    {
+        auto& node = nodes[static_cast<size_t>(nodeIndex)];
+
+        if (isFullyDry(node.type))
+        {
+            // Zero mix: the node would pass its input through untouched. Its state is dropped
+            // on the way in, so coming back out of bypass costs nothing.
+            if (!node.bypassed)
+            {
+                resetNode(node.type);
+                node.activity.sleep();
+                node.bypassed = true;
+            }
+
+            continue;
+        }
+
+        node.bypassed = false;
+
+        if (node.activity.update(inputIsSilent, numSamples))
+        {
+            if (fading)
+                processNodeFaded(node, buffer);
+            else
+                processNode(node, buffer);
         }
+
+        inputIsSilent = inputIsSilent && node.activity.isIdle();
+    }
+
+    // Every node is faded out: the chain is passing its input through, so the order can change
+    if (!orderGain.isSmoothing() && orderGain.getTargetValue() == 0.0f)
+    {
+        currentOrderIndex = requestedOrderIndex;
+        order = getOrder(currentOrderIndex);
+        orderGain.setTargetValue(1.0f);
+    }
+}
+
+std::array<int, EffectsProcessor::numNodes> EffectsProcessor::getOrder(int orderIndex) noexcept
+{
+    // Orders are the permutations of the nodes in lexicographic order
+    std::array<int, numNodes> permutation;
+    std::iota(permutation.begin(), permutation.end(), 0);
+
+    for (int i = 0; i < orderIndex; ++i)
+        std::next_permutation(permutation.begin(), permutation.end());
+
+    return permutation;
+}
+
+juce::StringArray EffectsProcessor::getOrderNames()
+{
+    static const char* const nodeNames[] = { "Delay", "Phaser", "Reverb" };
+    static_assert(std::size(nodeNames) == numNodes, "one name per node");
+
+    juce::StringArray names;
+    std::array<int, numNodes> permutation;
+    std::iota(permutation.begin(), permutation.end(), 0);
+
+    do
+    {
+        juce::StringArray parts;
+        for (auto nodeIndex : permutation)
+            parts.add(nodeNames[nodeIndex]);
+
+        names.add(parts.joinIntoString(" > "));
+    }
+    while (std::next_permutation(permutation.begin(), permutation.end()));
+
+    jassert(names.size() == numOrders);
+    return names;
+}
+
+void EffectsProcessor::attachParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    // Order must match ParameterIndex
+    parameters.attach(apvts, { "delayTime", "delaySync", "delayFeedback", "delayMix",
+                               "phaserRate", "phaserDepth", "phaserFeedback", "phaserMix",
+                               "effectsOrder", "reverbDecay", "reverbMix" });
+}
+
+void EffectsProcessor::updateParameters()
+{
+    parameters.refresh();
+
+    delaySyncIndex = juce::jlimit(0, static_cast<int>(std::size(delaySyncSteps)) - 1,
+                                  parameters.getInt(delaySyncParam));
+    updateDelayTime();
+
+    delay.setFeedback(parameters.get(delayFeedbackParam));
+    delay.setMix(parameters.get(delayMixParam));
+    updateTailLength();
+
+    if (parameters.consumeChange({ phaserRateParam, phaserDepthParam,
+                                   phaserFeedbackParam, phaserMixParam }, phaserVersion))
+    {
+        phaser.setRate(parameters.get(phaserRateParam));
+        phaser.setDepth(parameters.get(phaserDepthParam));
+        phaser.setFeedback(parameters.get(phaserFeedbackParam));
+        phaser.setMix(parameters.get(phaserMixParam));
+    }
+
+    if (parameters.consumeChange({ reverbDecayParam, reverbMixParam }, reverbVersion))
+    {
+        reverb.setDecay(parameters.get(reverbDecayParam));
+        reverb.setMix(parameters.get(reverbMixParam));
     }
 
-    delayWritePosition = (delayWritePosition + numSamples) % delayBufferSize;
+    requestedOrderIndex = juce::jlimit(0, numOrders - 1, parameters.getInt(effectsOrderParam));
 }
 
-void EffectsProcessor::updateParameters(juce::AudioProcessorValueTreeState& apvts)
+juce::StringArray EffectsProcessor::getDelaySyncNames()
 {
-    delayTime = apvts.getRawParameterValue("delayTime")->load();
-    delayFeedback = apvts.getRawParameterValue("delayFeedback")->load();
-    delayMix = apvts.getRawParameterValue("delayMix")->load();
+    // Order must match delaySyncSteps
+    return { "Free", "1/32", "1/16T", "1/16", "1/16.", "1/8T", "1/8", "1/8.", "1/4T", "1/4", "1/4.", "1/2" };
+}
+
+void EffectsProcessor::setSamplesPerStep(double newSamplesPerStep) noexcept
+{
+    if (newSamplesPerStep == samplesPerStep)
+        return;
+
+    samplesPerStep = newSamplesPerStep;
+    updateDelayTime();
+    updateTailLength();
+}
 
-    float phaserRate = apvts.getRawParameterValue("phaserRate")->load();
-    float phaserDepth = apvts.getRawParameterValue("phaserDepth")->load();
-    float phaserFeedback = apvts.getRawParameterValue("phaserFeedback")->load();
-    float phaserMix = apvts.getRawParameterValue("phaserMix")->load();
+void EffectsProcessor::updateDelayTime() noexcept
+{
+    // The engine glides to a new target by itself, so tempo changes bend the
+    // repeats smoothly instead of stepping
+    if (delaySyncIndex > 0 && samplesPerStep > 0.0)
+        delay.setDelayInSamples(samplesPerStep * delaySyncSteps[delaySyncIndex]);
+    else
+        delay.setDelayTime(parameters.get(delayTimeParam));
+}
 
-    auto& phaser = effectsChain.get<phaserIndex>();
-    phaser.setRate(phaserRate);
-    phaser.setDepth(phaserDepth);
-    phaser.setFeedback(phaserFeedback);
-    phaser.setMix(phaserMix);
-}
\ No newline at end of file
+void EffectsProcessor::updateTailLength() noexcept
+{
+    const double delayTail = delay.getTailLengthSeconds(SilenceTracker::silenceThreshold);
+    const double reverbTail = reverb.getTailLengthSeconds();
+
+    nodes[static_cast<size_t>(NodeType::delay)].activity.setTailLength(
+        static_cast<juce::int64>(std::ceil(delayTail * sampleRate)));
+    nodes[static_cast<size_t>(NodeType::reverb)].activity.setTailLength(
+        static_cast<juce::int64>(std::ceil(reverbTail * sampleRate)));
+    tailLengthSeconds.store(delayTail + phaserTailSeconds + reverbTail, std::memory_order_relaxed);
+}
@@ -1,42 +1,136 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../Utility/ParameterSnapshot.h"
+#include "DelayEngine.h"
+#include "StereoPhaser.h"
+#include "ConvolutionReverb.h"
+#include "../DSP/SilenceTracker.h"
 
 class EffectsProcessor
 {
 public:
+    // Nodes of the effects graph, in their default order
+    enum class NodeType { delay = 0, phaser, reverb, numNodes };
+    static constexpr int numNodes = static_cast<int>(NodeType::numNodes);
+
     EffectsProcessor();
     ~EffectsProcessor();
 
-    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    // numChannels is the number of distinct channels processBlock will see:
+    // 1 when the processor runs the mono pipeline
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels);
     void releaseResources();
 
+    // Runs the nodes in the selected order. A node whose mix has settled at
+    // zero is skipped, as is one whose input and tail have gone silent.
     void processBlock(juce::AudioBuffer<float>& buffer);
 
-    void updateParameters(juce::AudioProcessorValueTreeState& apvts);
+    // True when every node has rung out or is bypassed, so a silent input gives a silent output
+    bool isIdle() const noexcept;
+
+    // Current delay, phaser and reverb ring-out time; safe to call from any thread
+    double getTailLengthSeconds() const noexcept { return tailLengthSeconds.load(std::memory_order_relaxed); }
+
+    void attachParameters(juce::AudioProcessorValueTreeState& apvts);
+    void updateParameters();
+
+    // Note values offered by the delaySync parameter; index 0 is the free
+    // delayTime in seconds
+    static juce::StringArray getDelaySyncNames();
+
+    // Node orders offered by the effectsOrder parameter, e.g. "Delay > Phaser > Reverb"
+    static juce::StringArray getOrderNames();
+
+    // Partition size of the reverb's low-latency head, which is also its
+    // pre-delay. Smaller costs more CPU. Takes effect at the next prepareToPlay.
+    void setReverbHeadBlockSize(int newBlockSize) noexcept { reverbHeadBlockSize = newBlockSize; }
+
+    // Loads a reverb impulse file in the background; an empty File returns to
+    // the generated impulse. Call from the message thread.
+    void loadReverbImpulse(const juce::File& file) { reverb.loadImpulseResponse(file); }
+
+    // Step length of the sequencer clock for this block, used by the synced
+    // delay divisions so repeats land exactly on steps
+    void setSamplesPerStep(double newSamplesPerStep) noexcept;
 
 private:
-    dsp::ProcessorChain<dsp::DelayLine<float, dsp::DelayLineInterpolationTypes::Linear>,
-                        dsp::Phaser<float>> effectsChain;
+    enum ParameterIndex
+    {
+        delayTimeParam, delaySyncParam, delayFeedbackParam, delayMixParam,
+        phaserRateParam, phaserDepthParam, phaserFeedbackParam, phaserMixParam,
+        effectsOrderParam, reverbDecayParam, reverbMixParam
+    };
 
-    static constexpr size_t delayIndex = 0;
-    static constexpr size_t phaserIndex = 1;
+    ParameterSnapshot parameters;
+    uint32_t phaserVersion { 0 };
+    uint32_t reverbVersion { 0 };
 
-    double sampleRate { 44100.0 };
+    DelayEngine delay;
+    StereoPhaser phaser;
+    ConvolutionReverb reverb;
+    int reverbHeadBlockSize { 32 };
 
-    float delayTime { 0.375f };
-    float delayFeedback { 0.5f };
-    float delayMix { 0.3f };
+    static constexpr double maxDelaySeconds = 2.0;
 
-    std::vector<float> delayBuffer;
-    int delayBufferSize { 0 };
-    int delayWritePosition { 0 };
+    // Delay lengths of the synced divisions, in sixteenth-note steps
+    static constexpr double delaySyncSteps[] = { 0.0, 0.5, 2.0 / 3.0, 1.0, 1.5, 4.0 / 3.0,
+                                                 2.0, 3.0, 8.0 / 3.0, 4.0, 6.0, 8.0 };
 
-    // Comb filter removed - harmonics processor now in TB303Voice
+    int delaySyncIndex { 0 };
+    double samplesPerStep { 0.0 };
+
+    void updateDelayTime() noexcept;
 
-    juce::AudioBuffer<float> dryBuffer;
+    // Per-node state of the graph. Every effect mixes their own dry signal, so
+    // no node needs a separate dry copy.
+    struct Node
+    {
+        NodeType type { NodeType::delay };
+        SilenceTracker activity;
+        bool bypassed { true };
+    };
 
-    void processDelay(juce::AudioBuffer<float>& buffer);
+    std::array<Node, numNodes> nodes;
+    std::array<int, numNodes> order {};  // indices into nodes, in processing order
+
+    // A reorder ramps what every node adds to its input down to zero, switches
+    // the order while the chain passes its input through, then ramps the nodes
+    // back in. The dry signal keeps its level throughout.
+    static constexpr double orderFadeSeconds = 0.02;
+    int requestedOrderIndex { 0 };
+    int currentOrderIndex { 0 };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> orderGain { 1.0f };
+
+    // Scratch for the fade, sized in prepareToPlay: each node's input, and the block's ramp
+    juce::AudioBuffer<float> nodeInput;
+    juce::HeapBlock<float> orderGains;
+    int maxBlockSize { 0 };
+
+    // Every permutation of the nodes is an order
+    static constexpr int numOrders = []
+    {
+        int permutations = 1;
+        for (int n = 2; n <= numNodes; ++n)
+            permutations *= n;
+        return permutations;
+    }();
+
+    static std::array<int, numNodes> getOrder(int orderIndex) noexcept;
+
+    bool isFullyDry(NodeType type) const noexcept;
+    void processNode(Node& node, juce::AudioBuffer<float>& buffer) noexcept;
+    void processNodeFaded(Node& node, juce::AudioBuffer<float>& buffer) noexcept;
+    void resetNode(NodeType type) noexcept;
+
+    static constexpr double phaserTailSeconds = 0.5;
+    std::atomic<double> tailLengthSeconds { maxDelaySeconds };
+
+    void updateTailLength() noexcept;
+
+    double sampleRate { 44100.0 };
+
+    // Comb filter removed - harmonics processor now in TB303Voice
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectsProcessor)
-};
\ No newline at end of file
+};
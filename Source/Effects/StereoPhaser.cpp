@@ -0,0 +1,129 @@
+#include "StereoPhaser.h"
+
+void StereoPhaser::prepare(double sr, int newNumChannels)
+{
+    jassert(newNumChannels > 0 && newNumChannels <= maxChannels);
+
+    sampleRate = sr;
+    numChannels = juce::jlimit(1, maxChannels, newNumChannels);
+    maxFrequency = juce::jmin(20000.0f, static_cast<float>(0.49 * sampleRate));
+
+    lfo.prepare(sampleRate / controlInterval);
+    lfo.setFrequency(rate);
+    setCentreFrequency(centreFrequency);
+
+    feedback = targetFeedback;
+    mix.reset(sampleRate, mixRampSeconds);
+    reset();
+}
+
+void StereoPhaser::reset() noexcept
+{
+    for (auto& state : stageState)
+        state = Lanes::expand(0.0f);
+
+    lastOutput = Lanes::expand(0.0f);
+
+    lfo.reset();
+    coefficient = nextCoefficient();
+    coefficientStep = 0.0f;
+    samplesUntilUpdate = controlInterval;
+}
+
+void StereoPhaser::setRate(float newRateHz) noexcept
+{
+    if (newRateHz == rate)
+        return;
+
+    rate = newRateHz;
+    lfo.setFrequency(rate);
+}
+
+void StereoPhaser::setCentreFrequency(float newCentreHz) noexcept
+{
+    centreFrequency = juce::jlimit(20.0f, maxFrequency, newCentreHz);
+    normalisedCentre = juce::mapFromLog10(centreFrequency, 20.0f, maxFrequency);
+}
+
+float StereoPhaser::nextCoefficient() noexcept
+{
+    // Same sweep as dsp::Phaser: the LFO moves the centre on a log scale
+    // between 20 Hz and min(20 kHz, 0.49 fs)
+    const float sweep = juce::jlimit(0.0f, 1.0f, lfo.sin() * depth * 0.5f + normalisedCentre);
+    lfo.advance();
+
+    const float cutoff = juce::mapToLog10(sweep, 20.0f, maxFrequency);
+    const float g = std::tan(juce::MathConstants<float>::pi * cutoff / static_cast<float>(sampleRate));
+    return g / (1.0f + g);
+}
+
+void StereoPhaser::process(juce::AudioBuffer<float>& buffer) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (numSamples == 0)
+        return;
+
+    if (numChannels > 1 && buffer.getNumChannels() > 1)
+        processFrames<2>(buffer.getArrayOfWritePointers(), numSamples);
+    else if (buffer.getNumChannels() > 0)
+        processFrames<1>(buffer.getArrayOfWritePointers(), numSamples);
+}
+
+template <int channels>
+void StereoPhaser::processFrames(float* const* data, int numSamples) noexcept
+{
+    const auto two = Lanes::expand(2.0f);
+
+    // Feedback glides to its target across the block
+    const float feedbackStep = (targetFeedback - feedback) / static_cast<float>(numSamples);
+
+    // Unused lanes stay at zero so they never build up state of their own
+    alignas(32) float inputFrame[Lanes::SIMDNumElements] {};
+    alignas(32) float outputFrame[Lanes::SIMDNumElements] {};
+
+    for (int i = 0; i < numSamples;)
+    {
+        if (samplesUntilUpdate == 0)
+        {
+            coefficientStep = (nextCoefficient() - coefficient) / static_cast<float>(controlInterval);
+            samplesUntilUpdate = controlInterval;
+        }
+
+        const int segmentEnd = i + juce::jmin(samplesUntilUpdate, numSamples - i);
+        samplesUntilUpdate -= segmentEnd - i;
+
+        for (; i < segmentEnd; ++i)
+        {
+            coefficient += coefficientStep;
+            feedback += feedbackStep;
+            const float wet = mix.getNextValue();
+
+            for (int channel = 0; channel < channels; ++channel)
+                inputFrame[channel] = data[channel][i];
+
+            const auto dry = Lanes::fromRawArray(inputFrame);
+            const auto a = Lanes::expand(coefficient);
+
+            // Six TPT allpass stages, both channels at once
+            auto x = dry - lastOutput;
+
+            for (auto& state : stageState)
+            {
+                const auto v = (x - state) * a;
+                const auto lowpass = v + state;
+                state = lowpass + v;
+                x = lowpass * two - x;
+            }
+
+            lastOutput = x * Lanes::expand(feedback);
+
+            (dry + (x - dry) * Lanes::expand(wet)).copyToRawArray(outputFrame);
+
+            for (int channel = 0; channel < channels; ++channel)
+                data[channel][i] = outputFrame[channel];
+        }
+    }
+
+    feedback = targetFeedback;
+}
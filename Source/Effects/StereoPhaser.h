@@ -0,0 +1,70 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../DSP/QuadratureOscillator.h"
+
+// Six-stage allpass phaser with the same controls and voicing as
+// dsp::Phaser, restructured for speed:
+// - the left/right pair shares one dsp::SIMDRegister, so every allpass
+//   stage processes both channels with one set of instructions
+// - the LFO and the tan() behind the allpass coefficient run once per
+//   control interval, and the coefficient is interpolated linearly in between
+// - feedback glides across each block instead of through a per-sample
+//   SmoothedValue; the mix ramps over a fixed time so bypass never clicks
+class StereoPhaser
+{
+public:
+    static constexpr int numStages = 6;
+    static constexpr int controlInterval = 16;
+    static constexpr int maxChannels = 2;
+    static constexpr double mixRampSeconds = 0.02;
+
+    StereoPhaser() = default;
+
+    void prepare(double sampleRate, int numChannels);
+    // Clears the filters and restarts the LFO; feedback and mix keep gliding
+    void reset() noexcept;
+
+    void setRate(float newRateHz) noexcept;
+    void setDepth(float newDepth) noexcept { depth = juce::jlimit(0.0f, 1.0f, newDepth); }
+    void setCentreFrequency(float newCentreHz) noexcept;
+    void setFeedback(float newFeedback) noexcept { targetFeedback = juce::jlimit(-0.95f, 0.95f, newFeedback); }
+    void setMix(float newMix) noexcept { mix.setTargetValue(juce::jlimit(0.0f, 1.0f, newMix)); }
+
+    // True once the mix has settled at zero, so processing would return the input unchanged
+    bool isFullyDry() const noexcept { return mix.getCurrentValue() == 0.0f && mix.getTargetValue() == 0.0f; }
+
+    // Processes the first numChannels channels of the buffer in place
+    void process(juce::AudioBuffer<float>& buffer) noexcept;
+
+private:
+    using Lanes = juce::dsp::SIMDRegister<float>;
+
+    double sampleRate { 44100.0 };
+    int numChannels { 0 };
+
+    // Runs at sampleRate / controlInterval
+    QuadratureOscillator lfo;
+    float rate { 1.0f };
+    float depth { 0.5f };
+    float centreFrequency { 1300.0f };
+    float normalisedCentre { 0.0f };
+    float maxFrequency { 20000.0f };
+
+    float coefficient { 0.0f };
+    float coefficientStep { 0.0f };
+    int samplesUntilUpdate { 0 };
+
+    float feedback { 0.0f }, targetFeedback { 0.0f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> mix { 0.5f };
+
+    Lanes stageState[numStages];
+    Lanes lastOutput;
+
+    float nextCoefficient() noexcept;
+
+    template <int channels>
+    void processFrames(float* const* data, int numSamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StereoPhaser)
+};
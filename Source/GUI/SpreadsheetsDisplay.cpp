@@ -1,16 +1,12 @@
 #include "SpreadsheetsDisplay.h"
-#include "../PluginProcessor.h"
 #include <JuceHeader.h>
 
-SpreadsheetsDisplay::SpreadsheetsDisplay(SpreadsheetsSynthProcessor& p)
-    : processor(p)
+SpreadsheetsDisplay::SpreadsheetsDisplay()
 {
-    startTimerHz(30);
 }
 
 SpreadsheetsDisplay::~SpreadsheetsDisplay()
 {
-    stopTimer();
 }
 
 void SpreadsheetsDisplay::paint(juce::Graphics& g)
@@ -128,16 +124,15 @@ void SpreadsheetsDisplay::resized()
 {
 }
 
-void SpreadsheetsDisplay::timerCallback()
+void SpreadsheetsDisplay::noteStarted()
 {
-    int currentIndex = processor.getCurrentLetterIndex();
-
-    if (currentIndex != lastLetterIndex && currentIndex >= 0 && currentIndex < numLetters)
-    {
-        triggerLetter(currentIndex);
-        lastLetterIndex = currentIndex;
-    }
+    // Every note gets its own letter, however many arrive between frames
+    lastLetterIndex = (lastLetterIndex + 1) % numLetters;
+    triggerLetter(lastLetterIndex);
+}
 
+void SpreadsheetsDisplay::advanceAnimation()
+{
     bool needsRepaint = false;
 
     for (auto& state : letterStates)
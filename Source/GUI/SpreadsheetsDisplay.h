@@ -2,24 +2,23 @@
 
 #include <JuceHeader.h>
 
-class SpreadsheetsSynthProcessor;
-
-class SpreadsheetsDisplay : public juce::Component,
-                             public juce::Timer
+// Lights the next letter for every note played. Driven by the editor: it
+// calls noteStarted() per note event and advanceAnimation() on its timer.
+class SpreadsheetsDisplay : public juce::Component
 {
 public:
-    SpreadsheetsDisplay(SpreadsheetsSynthProcessor& processor);
+    SpreadsheetsDisplay();
     ~SpreadsheetsDisplay() override;
 
     void paint(juce::Graphics& g) override;
     void resized() override;
 
-    void timerCallback() override;
+    void noteStarted();
+    void advanceAnimation();
 
     void triggerLetter(int index);
 
 private:
-    SpreadsheetsSynthProcessor& processor;
 
     static constexpr const char* text = "SPREADSHEETS";
     static constexpr int numLetters = 12;
@@ -140,14 +140,24 @@ void XYPad::mouseDrag(const juce::MouseEvent& event)
 
 void XYPad::setXValue(float newX)
 {
-    xValue = juce::jlimit(0.0f, 1.0f, newX);
-    repaint();
+    newX = juce::jlimit(0.0f, 1.0f, newX);
+
+    if (newX != xValue)
+    {
+        xValue = newX;
+        repaint();
+    }
 }
 
 void XYPad::setYValue(float newY)
 {
-    yValue = juce::jlimit(0.0f, 1.0f, newY);
-    repaint();
+    newY = juce::jlimit(0.0f, 1.0f, newY);
+
+    if (newY != yValue)
+    {
+        yValue = newY;
+        repaint();
+    }
 }
 
 juce::Point<float> XYPad::getThumbPosition() const
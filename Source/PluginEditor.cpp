@@ -2,9 +2,56 @@
 #include "PluginEditor.h"
 #include "GUI/CRTShaderOverlay.h"
 
+namespace
+{
+    // Song chain text: pattern numbers from 1, each optionally followed by
+    // "x" and a bar count, e.g. "1x2 2 3x4". A bare number plays the pattern once.
+    SongChain parseSongChain(const juce::String& text, const PatternBank& bank)
+    {
+        SongChain chain;
+        auto tokens = juce::StringArray::fromTokens(text, " ,;", "");
+        tokens.removeEmptyStrings();
+
+        for (const auto& token : tokens)
+        {
+            if (chain.length == SongChain::maxEntries)
+                break;
+
+            const int pattern = token.upToFirstOccurrenceOf("x", false, true).getIntValue() - 1;
+
+            if (pattern < 0 || pattern >= PatternBank::numPatterns)
+                continue;
+
+            const int patternBars = (bank.patterns[static_cast<size_t>(pattern)].length + StepSequencer::stepsPerBar - 1)
+                                        / StepSequencer::stepsPerBar;
+            const int bars = token.containsIgnoreCase("x")
+                                 ? token.fromFirstOccurrenceOf("x", false, true).getIntValue()
+                                 : patternBars;
+
+            auto& entry = chain.entries[static_cast<size_t>(chain.length++)];
+            entry.pattern = static_cast<uint8_t>(pattern);
+            entry.bars = static_cast<uint8_t>(juce::jlimit(1, 255, bars));
+        }
+
+        return chain;
+    }
+
+    juce::String describeSongChain(const SongChain& chain)
+    {
+        juce::StringArray tokens;
+
+        for (int i = 0; i < chain.length; ++i)
+        {
+            const auto& entry = chain.entries[static_cast<size_t>(i)];
+            tokens.add(juce::String(entry.pattern + 1) + "x" + juce::String(entry.bars));
+        }
+
+        return tokens.joinIntoString(" ");
+    }
+}
+
 SpreadsheetsSynthEditor::SpreadsheetsSynthEditor (SpreadsheetsSynthProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p),
-      spreadsheetsDisplay(p)
+    : AudioProcessorEditor (&p), audioProcessor (p)
 {
     addAndMakeVisible(spreadsheetsDisplay);
 
@@ -21,15 +68,49 @@ SpreadsheetsSynthEditor::SpreadsheetsSynthEditor (SpreadsheetsSynthProcessor& p)
     setupSlider(accentKnob, "accent");
     setupSlider(overdriveKnob, "overdrive");
 
+    delaySyncSelector.addItemList(EffectsProcessor::getDelaySyncNames(), 1);
+    delaySyncAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "delaySync", delaySyncSelector);
+    delaySyncSelector.setTooltip("Lock the echo to the sequencer tempo, or Free to use the time knob");
+    addAndMakeVisible(delaySyncSelector);
+
     setupSlider(delayTimeKnob, "delayTime");
     setupSlider(delayFeedbackKnob, "delayFeedback");
     setupSlider(delayMixKnob, "delayMix");
 
+    effectsOrderSelector.addItemList(EffectsProcessor::getOrderNames(), 1);
+    effectsOrderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "effectsOrder", effectsOrderSelector);
+    effectsOrderSelector.setTooltip("Order of the effects chain; an effect with its mix at zero is bypassed");
+    addAndMakeVisible(effectsOrderSelector);
+
     setupSlider(phaserRateKnob, "phaserRate");
     setupSlider(phaserDepthKnob, "phaserDepth");
     setupSlider(phaserFeedbackKnob, "phaserFeedback");
     setupSlider(phaserMixKnob, "phaserMix");
 
+    setupSlider(reverbDecayKnob, "reverbDecay");
+    setupSlider(reverbMixKnob, "reverbMix");
+
+    // Cancelling the chooser goes back to the generated impulse
+    reverbImpulseButton.onClick = [this]()
+    {
+        impulseChooser = std::make_unique<juce::FileChooser>("Load reverb impulse", juce::File(),
+                                                             "*.wav;*.aif;*.aiff;*.flac");
+        impulseChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                    [this](const juce::FileChooser& chooser)
+                                    {
+                                        audioProcessor.getEffects().loadReverbImpulse(chooser.getResult());
+                                    });
+    };
+    reverbImpulseButton.setTooltip("Load a reverb impulse file; cancel to use the generated decay");
+    addAndMakeVisible(reverbImpulseButton);
+
+    pipelineToggle.setToggleState(audioProcessor.isPipelinedEffects(), juce::dontSendNotification);
+    pipelineToggle.onClick = [this] { audioProcessor.setPipelinedEffects(pipelineToggle.getToggleState()); };
+    pipelineToggle.setTooltip("Run the effects on a second core, one block behind");
+    addAndMakeVisible(pipelineToggle);
+
     // Setup harmonic XY pad
     combFilterPad.onValueChange = [this](float x, float y)
     {
@@ -60,15 +141,21 @@ SpreadsheetsSynthEditor::SpreadsheetsSynthEditor (SpreadsheetsSynthProcessor& p)
 
         auto slider = std::make_unique<juce::Slider>();
         slider->setSliderStyle(juce::Slider::LinearVertical);
-        slider->setRange(20.0, 20000.0, 1.0);
-        slider->setSkewFactorFromMidPoint(1000.0);
-        slider->setValue(1000.0);
-        slider->setTooltip("Per-step filter cutoff - Adjust brightness for this step");
+        slider->setTooltip("Per-step parameter lock - Move to lock this step, double-click to release");
         slider->addListener(this);
+        slider->addMouseListener(this, false);
         addAndMakeVisible(slider.get());
-        stepCutoffSliders.push_back(std::move(slider));
+        stepLockSliders.push_back(std::move(slider));
     }
 
+    lockTargetSelector.addItemList({ "Cutoff", "Resonance", "Decay", "Accent", "Overdrive" }, 1);
+    lockTargetSelector.setSelectedId(ParameterLocks::cutoff + 1, juce::dontSendNotification);
+    lockTargetSelector.onChange = [this]() { refreshStepLockSliders(); };
+    lockTargetSelector.setTooltip("Parameter the step sliders lock");
+    addAndMakeVisible(lockTargetSelector);
+
+    refreshStepLockSliders();
+
     playButton.addListener(this);
     stopButton.addListener(this);
     clearButton.addListener(this);
@@ -86,7 +173,7 @@ SpreadsheetsSynthEditor::SpreadsheetsSynthEditor (SpreadsheetsSynthProcessor& p)
 
     tempoSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     tempoSlider.setRange(60.0, 200.0, 1.0);
-    tempoSlider.setValue(120.0);
+    tempoSlider.setValue(audioProcessor.getSequencer().getInternalTempo(), juce::dontSendNotification);
     tempoSlider.setTooltip("Playback speed in BPM");
     tempoSlider.addListener(this);
     addAndMakeVisible(tempoSlider);
@@ -94,6 +181,32 @@ SpreadsheetsSynthEditor::SpreadsheetsSynthEditor (SpreadsheetsSynthProcessor& p)
     tempoLabel.setText("BPM", juce::dontSendNotification);
     addAndMakeVisible(tempoLabel);
 
+    // Pattern bank: the selected pattern is the one edited, and outside song
+    // mode it takes over playback at the next bar line
+    for (int i = 0; i < StepSequencer::numPatterns; ++i)
+        patternSelector.addItem("P" + juce::String(i + 1).paddedLeft('0', 3), i + 1);
+
+    patternSelector.setSelectedId(audioProcessor.getSequencer().getSelectedPattern() + 1, juce::dontSendNotification);
+    patternSelector.onChange = [this]()
+    {
+        audioProcessor.getSequencer().selectPattern(patternSelector.getSelectedId() - 1);
+        refreshStepLockSliders();
+        updateStepButtons();
+    };
+    patternSelector.setTooltip("Pattern to edit; plays from the next bar when song mode is off");
+    addAndMakeVisible(patternSelector);
+
+    songModeToggle.setToggleState(audioProcessor.getSequencer().isSongMode(), juce::dontSendNotification);
+    songModeToggle.onClick = [this]() { audioProcessor.getSequencer().setSongMode(songModeToggle.getToggleState()); };
+    songModeToggle.setTooltip("Play the song chain instead of the selected pattern");
+    addAndMakeVisible(songModeToggle);
+
+    songChainEditor.setText(describeSongChain(audioProcessor.getSequencer().getSongChain()), false);
+    songChainEditor.onReturnKey = [this]() { applySongChain(); };
+    songChainEditor.onFocusLost = [this]() { applySongChain(); };
+    songChainEditor.setTooltip("Song chain: pattern numbers, optionally with bars, e.g. 1x2 2 3x4");
+    addAndMakeVisible(songChainEditor);
+
     statusLabel.setText("[STATUS:STOPPED]", juce::dontSendNotification);
     statusLabel.setColour(juce::Label::textColourId, juce::Colours::white);
     statusLabel.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
@@ -111,7 +224,16 @@ SpreadsheetsSynthEditor::SpreadsheetsSynthEditor (SpreadsheetsSynthProcessor& p)
 
     setSize (800, 700);
 
-    startTimerHz(15);
+    // Start from the sequencer's current state; events queued while no
+    // editor was open are stale, so they are dropped
+    audioProcessor.getGuiEvents().drain([](const AudioEvent&) {});
+    displayedPlaying = audioProcessor.getSequencer().isPlaying();
+    displayedStep = audioProcessor.getSequencer().getCurrentStep();
+    updateTransportDisplay();
+    updateStepDisplay();
+    updateStepButtons();
+
+    startTimerHz(timerHz);
 }
 
 SpreadsheetsSynthEditor::~SpreadsheetsSynthEditor()
@@ -149,6 +271,10 @@ void SpreadsheetsSynthEditor::setupSlider(juce::Slider& slider, const juce::Stri
         slider.setTooltip("Resonance of phaser");
     else if (paramID == "phaserMix")
         slider.setTooltip("Wet/dry balance for phaser");
+    else if (paramID == "reverbDecay")
+        slider.setTooltip("Reverb decay time in seconds");
+    else if (paramID == "reverbMix")
+        slider.setTooltip("Wet/dry balance for reverb");
     // Harmonic parameters controlled by XY pad
     else if (paramID == "masterVolume")
         slider.setTooltip("Overall output volume");
@@ -235,7 +361,7 @@ void SpreadsheetsSynthEditor::resized()
         stepButtons[i]->setBounds(10 + i * stepSpacing, stepButtonY,
                                    stepButtonWidth, stepButtonHeight);
 
-        stepCutoffSliders[i]->setBounds(10 + i * stepSpacing, stepButtonY + 45,
+        stepLockSliders[i]->setBounds(10 + i * stepSpacing, stepButtonY + 45,
                                          stepButtonWidth, 80);  // Made taller: 60 -> 80
     }
 
@@ -247,9 +373,16 @@ void SpreadsheetsSynthEditor::resized()
     tempoLabel.setBounds(270, 330, 40, 30);
     tempoSlider.setBounds(310, 330, 120, 30);
 
+    patternSelector.setBounds(10, 372, 80, 26);
+    songModeToggle.setBounds(100, 372, 70, 26);
+    songChainEditor.setBounds(175, 372, 255, 26);
+    lockTargetSelector.setBounds(440, 372, 100, 26);
+
     statusLabel.setBounds(440, 330, 150, 30);
     debugLabel.setBounds(600, 330, 150, 30);
 
+    delaySyncSelector.setBounds(10, 410, 80, 30);
+    effectsOrderSelector.setBounds(10, 450, 80, 30);
     delayTimeKnob.setBounds(100, 410, 80, 80);
     delayFeedbackKnob.setBounds(190, 410, 80, 80);
     delayMixKnob.setBounds(280, 410, 80, 80);
@@ -260,6 +393,11 @@ void SpreadsheetsSynthEditor::resized()
     phaserMixKnob.setBounds(670, 410, 80, 80);
 
     combFilterPad.setBounds(10, 535, 150, 150);
+
+    reverbDecayKnob.setBounds(180, 535, 80, 80);
+    reverbMixKnob.setBounds(270, 535, 80, 80);
+    reverbImpulseButton.setBounds(360, 560, 40, 30);
+    pipelineToggle.setBounds(410, 560, 90, 30);
     // Comb filter mix knob removed - harmonics controlled by XY pad
 
     // CRT overlay covers entire window
@@ -268,25 +406,62 @@ void SpreadsheetsSynthEditor::resized()
 
 void SpreadsheetsSynthEditor::timerCallback()
 {
-    updateStepButtons();
+    // Everything the audio thread reported since the last tick, oldest first.
+    // Every note lights a letter; steps and transport only need their latest state.
+    int newStep = displayedStep;
+    bool newPlaying = displayedPlaying;
 
-    // Update status display
-    bool isPlaying = audioProcessor.getSequencer().isPlaying();
-    statusLabel.setText(isPlaying ? "[STATUS:PLAYING]" : "[STATUS:STOPPED]", juce::dontSendNotification);
-    statusLabel.setColour(juce::Label::textColourId, juce::Colours::white.withAlpha(isPlaying ? 1.0f : 0.6f));
+    audioProcessor.getGuiEvents().drain([&](const AudioEvent& event)
+    {
+        switch (event.type)
+        {
+            case AudioEvent::Type::noteOn:      spreadsheetsDisplay.noteStarted(); break;
+            case AudioEvent::Type::noteOff:     break;
+            case AudioEvent::Type::stepAdvance: newStep = event.value; break;
+            case AudioEvent::Type::transport:   newPlaying = event.value != 0; break;
+        }
+    });
 
-    // Update button appearance
-    playButton.setColour(juce::TextButton::buttonColourId,
-                        isPlaying ? juce::Colours::white.withAlpha(0.3f) : juce::Colours::black);
-    playButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::white.withAlpha(0.5f));
-    playButton.setColour(juce::TextButton::textColourOnId, juce::Colours::white);
-    playButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+    if (newPlaying != displayedPlaying || newStep != displayedStep)
+    {
+        const int previousStep = displayedStep;
+        displayedStep = newStep;
 
-    // Update step display
-    int currentStep = audioProcessor.getSequencer().getCurrentStep();
-    debugLabel.setText("Step: " + juce::String(currentStep + 1) + "/16 | Tempo: " +
-                        juce::String(audioProcessor.getSequencer().getTempo(), 1) + " BPM",
-                        juce::dontSendNotification);
+        if (newPlaying != displayedPlaying)
+        {
+            displayedPlaying = newPlaying;
+            updateTransportDisplay();
+        }
+
+        // Only the buttons losing and gaining the cursor repaint
+        if (juce::isPositiveAndBelow(previousStep, static_cast<int>(stepButtons.size())))
+            stepButtons[static_cast<size_t>(previousStep)]->setIsCurrent(false);
+
+        updateStepDisplay();
+        cursorBlinkTicks = 0;
+    }
+
+    // Blink the cursor on the current step
+    if (displayedPlaying && juce::isPositiveAndBelow(displayedStep, static_cast<int>(stepButtons.size())))
+        stepButtons[static_cast<size_t>(displayedStep)]->setCursorVisible(
+            (cursorBlinkTicks++ / cursorBlinkTicksPerPhase) % 2 == 0);
+
+    spreadsheetsDisplay.advanceAnimation();
+
+    // A restored state can switch the pipeline while the editor is open
+    pipelineToggle.setToggleState(audioProcessor.isPipelinedEffects(), juce::dontSendNotification);
+
+    // Layered voices play without the harmonic stage, so the pad only applies to a single voice
+    if (auto* voiceCount = audioProcessor.getAPVTS().getRawParameterValue("voiceCount"))
+    {
+        const bool harmonicsApply = voiceCount->load() < 1.5f;
+
+        if (combFilterPad.isEnabled() != harmonicsApply)
+        {
+            combFilterPad.setEnabled(harmonicsApply);
+            combFilterPad.setAlpha(harmonicsApply ? 1.0f : 0.4f);
+        }
+    }
 
     // Update XY pad from harmonic parameters
     if (auto* xParam = audioProcessor.getAPVTS().getRawParameterValue("harmonicAmount"))
@@ -297,39 +472,96 @@ void SpreadsheetsSynthEditor::timerCallback()
 
 void SpreadsheetsSynthEditor::updateStepButtons()
 {
-    int currentStep = audioProcessor.getSequencer().getCurrentStep();
-
+    // Called after edits; playback position comes from updateStepDisplay()
     for (int i = 0; i < 16; ++i)
     {
         auto step = audioProcessor.getSequencer().getStep(i);
         stepButtons[i]->updateState(step.isActive, step.hasSlide,
                                      step.hasAccent, step.isChained);
-        stepButtons[i]->setIsCurrent(i == currentStep &&
-                                      audioProcessor.getSequencer().isPlaying());
     }
 }
 
+void SpreadsheetsSynthEditor::updateTransportDisplay()
+{
+    statusLabel.setText(displayedPlaying ? "[STATUS:PLAYING]" : "[STATUS:STOPPED]", juce::dontSendNotification);
+    statusLabel.setColour(juce::Label::textColourId, juce::Colours::white.withAlpha(displayedPlaying ? 1.0f : 0.6f));
+
+    playButton.setColour(juce::TextButton::buttonColourId,
+                        displayedPlaying ? juce::Colours::white.withAlpha(0.3f) : juce::Colours::black);
+    playButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::white.withAlpha(0.5f));
+    playButton.setColour(juce::TextButton::textColourOnId, juce::Colours::white);
+    playButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+}
+
+void SpreadsheetsSynthEditor::updateStepDisplay()
+{
+    for (int i = 0; i < 16; ++i)
+        stepButtons[i]->setIsCurrent(i == displayedStep && displayedPlaying);
+
+    debugLabel.setText("Step: " + juce::String(displayedStep + 1) + "/16 | Tempo: " +
+                        juce::String(audioProcessor.getSequencer().getTempo(), 1) + " BPM",
+                        juce::dontSendNotification);
+}
+
 void SpreadsheetsSynthEditor::sliderValueChanged(juce::Slider* slider)
 {
     if (slider == &tempoSlider)
     {
         audioProcessor.getSequencer().setTempo(slider->getValue());
     }
-    else
+    else if (!refreshingStepLocks)
     {
         for (int i = 0; i < 16; ++i)
         {
-            if (slider == stepCutoffSliders[i].get())
+            if (slider == stepLockSliders[i].get())
             {
                 auto step = audioProcessor.getSequencer().getStep(i);
-                step.cutoffValue = static_cast<float>(slider->getValue());
-                audioProcessor.getSequencer().setStep(i, step);
+                step.locks.lock(getLockTarget(), static_cast<float>(slider->getValue()));
+
+                if (slider == draggedLockSlider)
+                    audioProcessor.getSequencer().stageStep(i, step);
+                else
+                    audioProcessor.getSequencer().setStep(i, step);
+
+                slider->setAlpha(1.0f);
                 break;
             }
         }
     }
 }
 
+void SpreadsheetsSynthEditor::sliderDragStarted(juce::Slider* slider)
+{
+    if (std::any_of(stepLockSliders.begin(), stepLockSliders.end(),
+                    [slider](const auto& lockSlider) { return lockSlider.get() == slider; }))
+        draggedLockSlider = slider;
+}
+
+void SpreadsheetsSynthEditor::sliderDragEnded(juce::Slider* slider)
+{
+    if (slider == draggedLockSlider)
+    {
+        draggedLockSlider = nullptr;
+        audioProcessor.getSequencer().publishEdits();
+    }
+}
+
+void SpreadsheetsSynthEditor::mouseDoubleClick(const juce::MouseEvent& event)
+{
+    // Double-clicking a step slider hands that step's parameter back to the knob
+    for (int i = 0; i < 16; ++i)
+    {
+        if (event.eventComponent == stepLockSliders[i].get())
+        {
+            auto step = audioProcessor.getSequencer().getStep(i);
+            step.locks.unlock(getLockTarget());
+            audioProcessor.getSequencer().setStep(i, step);
+            refreshStepLockSliders();
+            break;
+        }
+    }
+}
+
 void SpreadsheetsSynthEditor::buttonClicked(juce::Button* button)
 {
     if (button == &playButton)
@@ -342,14 +574,20 @@ void SpreadsheetsSynthEditor::buttonClicked(juce::Button* button)
     }
     else if (button == &clearButton)
     {
+        // Built as one pattern so playback switches to the cleared steps all at once
+        auto pattern = audioProcessor.getSequencer().getPattern();
+
         for (int i = 0; i < 16; ++i)
         {
             StepSequencer::Step step;
             step.noteNumber = 36 + (i % 12);
             step.isActive = false;
-            audioProcessor.getSequencer().setStep(i, step);
-            stepCutoffSliders[i]->setValue(1000.0);
+            pattern.setStep(i, step);
         }
+
+        audioProcessor.getSequencer().setPattern(pattern);
+        refreshStepLockSliders();
+        updateStepButtons();
     }
     else
     {
@@ -393,12 +631,52 @@ void SpreadsheetsSynthEditor::buttonClicked(juce::Button* button)
                 }
 
                 audioProcessor.getSequencer().setStep(i, step);
+                stepButtons[i]->updateState(step.isActive, step.hasSlide, step.hasAccent, step.isChained);
                 break;
             }
         }
     }
 }
 
+ParameterLocks::Target SpreadsheetsSynthEditor::getLockTarget() const
+{
+    return static_cast<ParameterLocks::Target>(juce::jlimit(0, ParameterLocks::numTargets - 1,
+                                                            lockTargetSelector.getSelectedId() - 1));
+}
+
+void SpreadsheetsSynthEditor::refreshStepLockSliders()
+{
+    // Order matches ParameterLocks::Target
+    static const juce::StringArray targetParameterIDs { "cutoff", "resonance", "decay", "accent", "overdrive" };
+
+    const auto target = getLockTarget();
+    const auto& parameterID = targetParameterIDs[target];
+    const auto range = audioProcessor.getAPVTS().getParameterRange(parameterID);
+    const float knobValue = audioProcessor.getAPVTS().getRawParameterValue(parameterID)->load();
+
+    const juce::ScopedValueSetter<bool> refreshing(refreshingStepLocks, true);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        // Unlocked steps show the knob they follow, dimmed
+        const auto locks = audioProcessor.getSequencer().getStep(i).locks;
+        auto& slider = *stepLockSliders[i];
+
+        slider.setNormalisableRange({ range.start, range.end, range.interval, range.skew });
+        slider.setValue(locks.apply(target, knobValue), juce::dontSendNotification);
+        slider.setAlpha(locks.isLocked(target) ? 1.0f : 0.4f);
+    }
+}
+
+void SpreadsheetsSynthEditor::applySongChain()
+{
+    auto& sequencer = audioProcessor.getSequencer();
+    sequencer.setSongChain(parseSongChain(songChainEditor.getText(), sequencer.getBank()));
+
+    // Show the chain as understood, with bar counts filled in
+    songChainEditor.setText(describeSongChain(sequencer.getSongChain()), false);
+}
+
 void SpreadsheetsSynthEditor::randomizePattern()
 {
     juce::Random random;
@@ -465,6 +743,8 @@ void SpreadsheetsSynthEditor::randomizePattern()
     int baseNote = 36 + random.nextInt(12); // C2 to B2
     float stepProbability = 0.7f; // 70% chance each step is active
 
+    auto pattern = audioProcessor.getSequencer().getPattern();
+
     for (int i = 0; i < 16; ++i)
     {
         StepSequencer::Step step;
@@ -496,37 +776,39 @@ void SpreadsheetsSynthEditor::randomizePattern()
                 step.isChained = true;
             }
 
-            // Random per-step cutoff with bias toward mid frequencies
+            // Random per-step cutoff lock with bias toward mid frequencies
             float cutoffRange = random.nextFloat();
             if (cutoffRange < 0.6f)
             {
                 // 60% chance: mid range (500-2000 Hz)
-                step.cutoffValue = 500.0f + random.nextFloat() * 1500.0f;
+                step.locks.lock(ParameterLocks::cutoff, 500.0f + random.nextFloat() * 1500.0f);
             }
             else if (cutoffRange < 0.85f)
             {
                 // 25% chance: low range (200-500 Hz)
-                step.cutoffValue = 200.0f + random.nextFloat() * 300.0f;
+                step.locks.lock(ParameterLocks::cutoff, 200.0f + random.nextFloat() * 300.0f);
             }
             else
             {
                 // 15% chance: high range (2000-8000 Hz)
-                step.cutoffValue = 2000.0f + random.nextFloat() * 6000.0f;
+                step.locks.lock(ParameterLocks::cutoff, 2000.0f + random.nextFloat() * 6000.0f);
             }
         }
         else
         {
             step.noteNumber = baseNote;
             step.velocity = 0.7f;
-            step.cutoffValue = 1000.0f;
         }
 
-        audioProcessor.getSequencer().setStep(i, step);
-
-        // Update the UI slider for this step's cutoff
-        stepCutoffSliders[i]->setValue(step.cutoffValue);
+        pattern.setStep(i, step);
     }
 
+    // Published as one pattern so playback never hears a half-randomized one
+    audioProcessor.getSequencer().setPattern(pattern);
+
+    // Update the UI sliders for each step's locks
+    refreshStepLockSliders();
+
     // Update button states
     updateStepButtons();
 }
\ No newline at end of file
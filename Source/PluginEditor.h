@@ -14,6 +14,9 @@ public:
 
     void updateState(bool active, bool slide, bool accent, bool chain)
     {
+        if (active == isActive && slide == hasSlide && accent == hasAccent && chain == isChained)
+            return;
+
         isActive = active;
         hasSlide = slide;
         hasAccent = accent;
@@ -61,10 +64,8 @@ public:
         // Current step indicator
         if (isCurrent)
         {
-            // Flashing cursor effect
-            static int flashCounter = 0;
-            flashCounter++;
-            if ((flashCounter / 15) % 2 == 0)
+            // Flashing cursor effect, blinked by the editor
+            if (cursorVisible)
             {
                 g.setColour(juce::Colours::white);
                 g.drawRect(bounds.reduced(1), 2.0f);
@@ -83,7 +84,25 @@ public:
         }
     }
 
-    void setIsCurrent(bool current) { isCurrent = current; repaint(); }
+    void setIsCurrent(bool current)
+    {
+        if (current != isCurrent)
+        {
+            isCurrent = current;
+            repaint();
+        }
+    }
+
+    void setCursorVisible(bool visible)
+    {
+        if (visible != cursorVisible)
+        {
+            cursorVisible = visible;
+
+            if (isCurrent)
+                repaint();
+        }
+    }
 
 private:
     int stepNum;
@@ -92,6 +111,7 @@ private:
     bool hasAccent = false;
     bool isChained = false;
     bool isCurrent = false;
+    bool cursorVisible = true;
 };
 
 class SpreadsheetsSynthEditor : public juce::AudioProcessorEditor,
@@ -108,7 +128,10 @@ public:
 
     void timerCallback() override;
     void sliderValueChanged(juce::Slider* slider) override;
+    void sliderDragStarted(juce::Slider* slider) override;
+    void sliderDragEnded(juce::Slider* slider) override;
     void buttonClicked(juce::Button* button) override;
+    void mouseDoubleClick(const juce::MouseEvent& event) override;
 
 private:
     SpreadsheetsSynthProcessor& audioProcessor;
@@ -125,15 +148,28 @@ private:
     juce::Slider accentKnob;
     juce::Slider overdriveKnob;
 
+    juce::ComboBox delaySyncSelector;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> delaySyncAttachment;
+
     juce::Slider delayTimeKnob;
     juce::Slider delayFeedbackKnob;
     juce::Slider delayMixKnob;
 
+    juce::ComboBox effectsOrderSelector;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> effectsOrderAttachment;
+
     juce::Slider phaserRateKnob;
     juce::Slider phaserDepthKnob;
     juce::Slider phaserFeedbackKnob;
     juce::Slider phaserMixKnob;
 
+    juce::Slider reverbDecayKnob;
+    juce::Slider reverbMixKnob;
+    juce::TextButton reverbImpulseButton {"IR"};
+    std::unique_ptr<juce::FileChooser> impulseChooser;
+
+    juce::ToggleButton pipelineToggle {"Pipeline"};
+
     XYPad combFilterPad;  // Now controls harmonics/subharmonics
 
     juce::Slider masterVolumeKnob;
@@ -141,7 +177,12 @@ private:
     std::vector<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>> sliderAttachments;
 
     std::vector<std::unique_ptr<StepButton>> stepButtons;
-    std::vector<std::unique_ptr<juce::Slider>> stepCutoffSliders;
+    std::vector<std::unique_ptr<juce::Slider>> stepLockSliders;
+
+    // Which locked parameter the step sliders show and edit
+    juce::ComboBox lockTargetSelector;
+    bool refreshingStepLocks { false };
+    juce::Slider* draggedLockSlider { nullptr };  // its edits are published when the drag ends
 
     juce::TextButton playButton {"Play"};
     juce::TextButton stopButton {"Stop"};
@@ -151,12 +192,28 @@ private:
     juce::Slider tempoSlider;
     juce::Label tempoLabel;
 
+    juce::ComboBox patternSelector;
+    juce::ToggleButton songModeToggle {"Song"};
+    juce::TextEditor songChainEditor;
+
     juce::Label statusLabel;
     juce::Label debugLabel;
 
+    // Sequencer state as last reported by the audio thread's events
+    int displayedStep { 0 };
+    bool displayedPlaying { false };
+    int cursorBlinkTicks { 0 };
+    static constexpr int timerHz = 30;
+    static constexpr int cursorBlinkTicksPerPhase = 15;
+
     void setupSlider(juce::Slider& slider, const juce::String& paramID);
     void updateStepButtons();
+    void updateTransportDisplay();
+    void updateStepDisplay();
     void randomizePattern();
+    ParameterLocks::Target getLockTarget() const;
+    void refreshStepLockSliders();
+    void applySongChain();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpreadsheetsSynthEditor)
 };
\ No newline at end of file
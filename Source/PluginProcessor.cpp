@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Utility/AllocationGuard.h"
 
 SpreadsheetsSynthProcessor::SpreadsheetsSynthProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -14,6 +15,10 @@ SpreadsheetsSynthProcessor::SpreadsheetsSynthProcessor()
 #endif
     apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+    synth.attachParameters(apvts);
+    effectsProcessor.attachParameters(apvts);
+    sequencer.setGuiEvents(&guiEvents);
+    masterVolumeParameter = apvts.getRawParameterValue("masterVolume");
 }
 
 SpreadsheetsSynthProcessor::~SpreadsheetsSynthProcessor()
@@ -45,6 +50,9 @@ juce::AudioProcessorValueTreeState::ParameterLayout SpreadsheetsSynthProcessor::
     params.push_back(std::make_unique<juce::AudioParameterFloat>("delayTime", "Delay Time",
         juce::NormalisableRange<float>(0.01f, 2.0f, 0.01f), 0.375f));
 
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("delaySync", "Delay Sync",
+        EffectsProcessor::getDelaySyncNames(), 0));
+
     params.push_back(std::make_unique<juce::AudioParameterFloat>("delayFeedback", "Delay Feedback",
         juce::NormalisableRange<float>(0.0f, 0.95f, 0.01f), 0.5f));
 
@@ -63,12 +71,29 @@ juce::AudioProcessorValueTreeState::ParameterLayout SpreadsheetsSynthProcessor::
     params.push_back(std::make_unique<juce::AudioParameterFloat>("phaserMix", "Phaser Mix",
         juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.5f));
 
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("effectsOrder", "Effects Order",
+        EffectsProcessor::getOrderNames(), 0));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("reverbDecay", "Reverb Decay",
+        juce::NormalisableRange<float>(0.3f, 8.0f, 0.01f, 0.5f), 2.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("reverbMix", "Reverb Mix",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.0f));
+
     params.push_back(std::make_unique<juce::AudioParameterFloat>("harmonicAmount", "LFO Rate",
         juce::NormalisableRange<float>(0.1f, 20.0f, 0.01f, 0.3f), 2.0f)); // Exponential skew for musical rates
 
     params.push_back(std::make_unique<juce::AudioParameterFloat>("subharmonicDepth", "LFO Depth",
         juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.3f));
 
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("harmonicShaping", "Harmonic Anti-Aliasing",
+        juce::StringArray{"Oversampled", "ADAA 1st Order", "ADAA 2nd Order"}, 0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>("voiceCount", "Voice Layers", 1, 8, 1));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("voiceSpread", "Layer Spread",
+        juce::StringArray{"Unison", "Octaves"}, 0));
+
     params.push_back(std::make_unique<juce::AudioParameterFloat>("masterVolume", "Master Volume",
         juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.7f));
 
@@ -109,7 +134,8 @@ bool SpreadsheetsSynthProcessor::isMidiEffect() const
 
 double SpreadsheetsSynthProcessor::getTailLengthSeconds() const
 {
-    return 2.0;
+    // Follows delayTime/delaySync and delayFeedback
+    return effectsProcessor.getTailLengthSeconds();
 }
 
 int SpreadsheetsSynthProcessor::getNumPrograms()
@@ -137,13 +163,61 @@ void SpreadsheetsSynthProcessor::changeProgramName (int index, const juce::Strin
 
 void SpreadsheetsSynthProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    // The voices are mono, and every effect treats its channels identically:
+    // the delay and phaser share one setting across channels and the reverb
+    // folds its impulse to mono. With no audio input the effects output is
+    // therefore mono, so the chain runs on one channel and is fanned out to
+    // the output channels at the end
+    const int numOutputChannels = getTotalNumOutputChannels();
+    monoPipeline = getTotalNumInputChannels() == 0;
+
+    numEffectsChannels = monoPipeline ? 1 : juce::jmax(1, numOutputChannels);
+
+    // Stop the worker before the effects it runs are re-prepared
+    effectsPipeline.release();
+
     synth.prepareToPlay(sampleRate, samplesPerBlock);
     sequencer.prepareToPlay(sampleRate, samplesPerBlock);
-    effectsProcessor.prepareToPlay(sampleRate, samplesPerBlock);
+    effectsProcessor.prepareToPlay(sampleRate, samplesPerBlock, numEffectsChannels);
+
+    isPrepared = true;
+    configureEffectsPipeline();
+
+    // Reserve MIDI storage up front so processBlock never grows the buffer
+    sequencerMidi.ensureSize(midiBufferReserveBytes);
+
+    samplesProcessed = 0;
+}
+
+void SpreadsheetsSynthProcessor::configureEffectsPipeline()
+{
+    // Pipelined mode trades one block of latency for running the effects on a second core
+    effectsPipeline.release();
+    pipelinedEffects = pipelineRequested.load();
+
+    if (pipelinedEffects)
+        effectsPipeline.prepare(getSampleRate(), numEffectsChannels, getBlockSize());
+
+    // Tells the host when the latency changes
+    setLatencySamples(pipelinedEffects ? effectsPipeline.getLatencySamples() : 0);
+}
+
+void SpreadsheetsSynthProcessor::setPipelinedEffects(bool shouldPipeline)
+{
+    if (pipelineRequested.exchange(shouldPipeline) == shouldPipeline || !isPrepared)
+        return;  // unchanged, or prepareToPlay will pick it up
+
+    // Holding the audio callback off makes the switch land between two blocks.
+    // The effects keep their state; only the pipeline's in-flight block is dropped.
+    suspendProcessing(true);
+    configureEffectsPipeline();
+    suspendProcessing(false);
 }
 
 void SpreadsheetsSynthProcessor::releaseResources()
 {
+    isPrepared = false;
+    effectsPipeline.release();
     synth.releaseResources();
     effectsProcessor.releaseResources();
 }
@@ -172,6 +246,7 @@ bool SpreadsheetsSynthProcessor::isBusesLayoutSupported (const BusesLayout& layo
 void SpreadsheetsSynthProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    ScopedNoAllocationCheck noAllocations;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -180,38 +255,88 @@ void SpreadsheetsSynthProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 
     updateParameters();
 
-    juce::MidiBuffer sequencerMidi;
+    guiEvents.beginBlock(samplesProcessed);
+    samplesProcessed += buffer.getNumSamples();
+
+    sequencerMidi.clear();
     sequencer.processBlock(buffer, sequencerMidi, getPlayHead());
 
-    juce::MidiBuffer combinedMidi;
-    combinedMidi.addEvents(midiMessages, 0, buffer.getNumSamples(), 0);
-    combinedMidi.addEvents(sequencerMidi, 0, buffer.getNumSamples(), 0);
+    if (!pipelinedEffects)
+        effectsProcessor.setSamplesPerStep(sequencer.getSamplesPerStep());
+
+    auto masterVolume = masterVolumeParameter->load();
+
+    // With no voices sounding and no events to start one or move its
+    // parameters, the synth has nothing to render
+    const bool synthIsActive = synth.isActive() || !midiMessages.isEmpty() || !sequencerMidi.isEmpty()
+                               || sequencer.getParameterLocks().size() > 0;
 
-    for (const auto metadata : combinedMidi)
+    if (monoPipeline && buffer.getNumChannels() > 1)
     {
-        if (metadata.getMessage().isNoteOn())
-        {
-            noteTriggered(metadata.getMessage().getNoteNumber());
-        }
+        // Render and process channel 0 only; this view refers to the host's
+        // memory and uses AudioBuffer's preallocated channel table
+        juce::AudioBuffer<float> monoBuffer(buffer.getArrayOfWritePointers(), 1, buffer.getNumSamples());
+
+        renderAndProcess(monoBuffer, midiMessages, synthIsActive, masterVolume);
+
+        if (monoBuffer.hasBeenCleared())
+            buffer.clear();
+        else
+            for (int channel = 1; channel < buffer.getNumChannels(); ++channel)
+                buffer.copyFrom(channel, 0, buffer, 0, 0, buffer.getNumSamples());
     }
+    else
+    {
+        renderAndProcess(buffer, midiMessages, synthIsActive, masterVolume);
+    }
+}
 
-    synth.processBlock(buffer, combinedMidi);
+void SpreadsheetsSynthProcessor::renderAndProcess(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& hostMidi,
+                                                  bool synthIsActive, float masterVolume)
+{
+    // Host and sequencer events are played from their own buffers in one
+    // merged pass, which also reports the notes to the editor
+    if (synthIsActive)
+        synth.processBlock(buffer, hostMidi, sequencerMidi, sequencer.getParameterLocks(),
+                           [this](const juce::MidiMessage& message, int samplePosition)
+                           {
+                               guiEvents.push(message.isNoteOn() ? AudioEvent::Type::noteOn : AudioEvent::Type::noteOff,
+                                              message.getNoteNumber(), samplePosition);
+                           });
+    else
+        buffer.clear();  // sets the clear flag, so the effects skip their silence scan
+
+    bool outputIsSilent;
+
+    if (pipelinedEffects)
+    {
+        // The buffer now holds the effected output of an earlier block
+        effectsPipeline.process(buffer, sequencer.getSamplesPerStep(), !synthIsActive);
+        outputIsSilent = effectsPipeline.isOutputSilent();
+    }
+    else
+    {
+        effectsProcessor.processBlock(buffer);
+        outputIsSilent = !synthIsActive && effectsProcessor.isIdle();
+    }
 
-    effectsProcessor.processBlock(buffer);
+    // Once every stage has rung out the output is exactly silent; flag it clear
+    if (outputIsSilent)
+    {
+        buffer.clear();
+        return;
+    }
 
-    auto masterVolume = apvts.getRawParameterValue("masterVolume")->load();
     buffer.applyGain(masterVolume);
 }
 
 void SpreadsheetsSynthProcessor::updateParameters()
 {
-    synth.updateParameters(apvts);
-    effectsProcessor.updateParameters(apvts);
-}
+    synth.updateParameters();
 
-void SpreadsheetsSynthProcessor::noteTriggered(int noteNumber)
-{
-    currentLetterIndex = (currentLetterIndex + 1) % 12;
+    // In pipelined mode the worker updates the effects before each block it runs
+    if (!pipelinedEffects)
+        effectsProcessor.updateParameters();
 }
 
 bool SpreadsheetsSynthProcessor::hasEditor() const
@@ -224,20 +349,150 @@ juce::AudioProcessorEditor* SpreadsheetsSynthProcessor::createEditor()
     return new SpreadsheetsSynthEditor (*this);
 }
 
+namespace
+{
+    // State layout: magic, version, then tagged chunks of [tag][size][payload].
+    // Readers skip chunks they do not know, so later versions can add chunks
+    // without breaking older builds. Anything else is the XML of earlier builds.
+    // Version 2 stores the tempo as a double; version 1 stored a float.
+    const int stateMagic = (int) juce::ByteOrder::littleEndianInt ("SPSY");
+    constexpr int stateVersion = 2;
+    const int parametersChunk = (int) juce::ByteOrder::littleEndianInt ("PRMS");
+    const int sequencerChunk = (int) juce::ByteOrder::littleEndianInt ("SEQ ");
+    const int settingsChunk = (int) juce::ByteOrder::littleEndianInt ("OPTS");
+
+    void writeChunk (juce::OutputStream& output, int tag, const juce::MemoryOutputStream& payload)
+    {
+        output.writeInt (tag);
+        output.writeInt ((int) payload.getDataSize());
+        output.write (payload.getData(), payload.getDataSize());
+    }
+}
+
 void SpreadsheetsSynthProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    juce::MemoryOutputStream output (destData, false);
+    output.writeInt (stateMagic);
+    output.writeShort ((short) stateVersion);
+
+    {
+        juce::MemoryOutputStream payload;
+        const auto& parameters = getParameters();
+        payload.writeCompressedInt (parameters.size());
+
+        for (auto* parameter : parameters)
+        {
+            auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter);
+            payload.writeString (withID != nullptr ? withID->paramID : juce::String());
+            payload.writeFloat (parameter->getValue());
+        }
+
+        writeChunk (output, parametersChunk, payload);
+    }
+
+    {
+        juce::MemoryOutputStream payload;
+        // Hosts may save from any thread while the editor edits the bank
+        auto bank = std::make_unique<PatternBank>();
+        sequencer.copyBank (*bank);
+
+        payload.writeDouble (sequencer.getInternalTempo());
+        bank->writeTo (payload);
+        writeChunk (output, sequencerChunk, payload);
+    }
+
+    {
+        juce::MemoryOutputStream payload;
+        payload.writeBool (isPipelinedEffects());
+        writeChunk (output, settingsChunk, payload);
+    }
 }
 
 void SpreadsheetsSynthProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    if (sizeInBytes >= 6 && (int) juce::ByteOrder::littleEndianInt (data) == stateMagic)
+    {
+        readBinaryState (data, sizeInBytes);
+        return;
+    }
+
+    // State saved by builds before the binary format
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
+    {
         if (xmlState->hasTagName (apvts.state.getType()))
             apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+        // Earlier builds stored the pipeline setting as a parameter
+        if (auto* pipelineParam = xmlState->getChildByAttribute ("id", "pipelinedEffects"))
+            setPipelinedEffects (pipelineParam->getDoubleAttribute ("value") > 0.5);
+    }
+}
+
+void SpreadsheetsSynthProcessor::readBinaryState (const void* data, int sizeInBytes)
+{
+    juce::MemoryInputStream input (data, (size_t) sizeInBytes, false);
+    input.readInt();
+
+    const int version = input.readShort();
+
+    if (version > stateVersion)
+        return;
+
+    while (input.getNumBytesRemaining() >= 8)
+    {
+        const int tag = input.readInt();
+        const int size = input.readInt();
+
+        if (size < 0 || size > input.getNumBytesRemaining())
+            return;
+
+        const auto chunkEnd = input.getPosition() + size;
+        juce::MemoryInputStream chunk (static_cast<const char*> (data) + input.getPosition(), (size_t) size, false);
+
+        if (tag == parametersChunk)
+        {
+            std::map<juce::String, float> storedValues;
+            const int numStored = chunk.readCompressedInt();
+
+            for (int i = 0; i < numStored && ! chunk.isExhausted(); ++i)
+            {
+                auto paramID = chunk.readString();
+                storedValues[paramID] = chunk.readFloat();
+            }
+
+            // Parameters missing from the state go back to their defaults. The
+            // host asked for this state, so it is not told about each change;
+            // the listeners (the APVTS and the editor) still are.
+            for (auto* parameter : getParameters())
+            {
+                auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter);
+                const auto stored = withID != nullptr ? storedValues.find (withID->paramID) : storedValues.end();
+                const float value = stored != storedValues.end() ? juce::jlimit (0.0f, 1.0f, stored->second)
+                                                                 : parameter->getDefaultValue();
+                parameter->setValue (value);
+                parameter->sendValueChangedMessageToListeners (value);
+            }
+        }
+        else if (tag == settingsChunk && size >= 1)
+        {
+            setPipelinedEffects (chunk.readBool());
+        }
+        else if (tag == sequencerChunk && size >= (version >= 2 ? 8 : 4))
+        {
+            const double tempo = version >= 2 ? chunk.readDouble() : (double) chunk.readFloat();
+            auto bank = std::make_unique<PatternBank>();
+
+            if (bank->readFrom (chunk))
+            {
+                sequencer.setBank (*bank);
+                sequencer.setTempo (tempo);
+            }
+        }
+
+        input.setPosition (chunkEnd);
+    }
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -4,6 +4,8 @@
 #include "Synth/TB303Synth.h"
 #include "Sequencer/StepSequencer.h"
 #include "Effects/EffectsProcessor.h"
+#include "Effects/EffectsPipeline.h"
+#include "Utility/AudioEventFifo.h"
 
 class SpreadsheetsSynthProcessor : public juce::AudioProcessor
 {
@@ -42,21 +44,47 @@ public:
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
     TB303Synth& getSynth() { return synth; }
     StepSequencer& getSequencer() { return sequencer; }
+    EffectsProcessor& getEffects() { return effectsProcessor; }
 
-    void noteTriggered(int noteNumber);
-    int getCurrentLetterIndex() const { return currentLetterIndex.load(); }
+    // Notes, steps and transport changes from the audio thread, for the editor to drain
+    AudioEventFifo& getGuiEvents() { return guiEvents; }
+
+    // Runs the effects on a second core, one block behind. A setting rather
+    // than a parameter: switching restarts the pipeline and changes the
+    // reported latency, so it is not automatable. Call from the message thread.
+    void setPipelinedEffects(bool shouldPipeline);
+    bool isPipelinedEffects() const { return pipelineRequested.load(); }
 
 private:
     TB303Synth synth;
     StepSequencer sequencer;
     EffectsProcessor effectsProcessor;
+    EffectsPipeline effectsPipeline { effectsProcessor };
+
+    static constexpr size_t midiBufferReserveBytes = 4096;
+    juce::MidiBuffer sequencerMidi;
 
     juce::AudioProcessorValueTreeState apvts;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    std::atomic<int> currentLetterIndex { 0 };
+    std::atomic<float>* masterVolumeParameter { nullptr };
+
+    bool monoPipeline { true };
+    int numEffectsChannels { 1 };
+    bool isPrepared { false };
+    std::atomic<bool> pipelineRequested { false };
+    bool pipelinedEffects { false };  // the mode the audio thread is running in
+
+    AudioEventFifo guiEvents;
+    juce::int64 samplesProcessed { 0 };
 
     void updateParameters();
+    void configureEffectsPipeline();
+    void renderAndProcess(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& hostMidi,
+                          bool synthIsActive, float masterVolume);
+
+    // Restores the binary state written by getStateInformation
+    void readBinaryState(const void* data, int sizeInBytes);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpreadsheetsSynthProcessor)
 };
\ No newline at end of file
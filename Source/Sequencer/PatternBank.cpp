@@ -0,0 +1,198 @@
+#include "PatternBank.h"
+
+namespace
+{
+    constexpr float minCutoff = 20.0f;
+    constexpr float maxCutoff = 20000.0f;
+
+    // Knob ranges of the linearly coded locks, from resonance to overdrive
+    struct LockRange { float start, end; };
+    constexpr LockRange lockRanges[] = { { 0.0f, 1.0f }, { 0.01f, 2.0f }, { 0.0f, 1.0f }, { 0.0f, 1.0f } };
+}
+
+PackedStep::PackedStep(const SequencerStep& step) noexcept
+{
+    const auto note = static_cast<uint64_t>(juce::jlimit(0, 127, step.noteNumber));
+    const auto velocity = static_cast<uint64_t>(juce::roundToInt(juce::jlimit(0.0f, 1.0f, step.velocity) * 127.0f));
+
+    bits = note
+         | (velocity << 7)
+         | (step.isActive ? activeFlag : 0u)
+         | (step.hasSlide ? slideFlag : 0u)
+         | (step.hasAccent ? accentFlag : 0u)
+         | (step.isChained ? chainedFlag : 0u)
+         | (static_cast<uint64_t>(step.locks.mask & lockMaskBits) << lockMaskShift);
+
+    const auto& locks = step.locks;
+
+    if (locks.isLocked(ParameterLocks::cutoff))
+    {
+        const float cutoff = juce::jlimit(minCutoff, maxCutoff, locks.values[ParameterLocks::cutoff]);
+        const auto code = static_cast<uint64_t>(juce::roundToInt(
+            juce::mapFromLog10(cutoff, minCutoff, maxCutoff) * static_cast<float>(maxCutoffCode)));
+        bits |= code << cutoffShift;
+    }
+
+    for (int target = ParameterLocks::resonance; target < ParameterLocks::numTargets; ++target)
+    {
+        if (!locks.isLocked(static_cast<ParameterLocks::Target>(target)))
+            continue;
+
+        const auto& range = lockRanges[target - ParameterLocks::resonance];
+        const float proportion = (juce::jlimit(range.start, range.end, locks.values[target]) - range.start)
+                                     / (range.end - range.start);
+        const auto code = static_cast<uint64_t>(juce::roundToInt(proportion * static_cast<float>(maxValueCode)));
+        bits |= code << (firstValueShift + 7 * (target - ParameterLocks::resonance));
+    }
+}
+
+SequencerStep PackedStep::unpack() const noexcept
+{
+    SequencerStep step;
+    step.noteNumber = getNoteNumber();
+    step.velocity = static_cast<float>(getVelocity()) / 127.0f;
+    step.isActive = isActive();
+    step.hasSlide = hasSlide();
+    step.hasAccent = hasAccent();
+    step.isChained = isChained();
+    step.locks = getLocks();
+    return step;
+}
+
+ParameterLocks PackedStep::getLocks() const noexcept
+{
+    ParameterLocks locks;
+    locks.mask = static_cast<uint8_t>((bits >> lockMaskShift) & lockMaskBits);
+
+    if (locks.isEmpty())
+        return locks;
+
+    if (locks.isLocked(ParameterLocks::cutoff))
+    {
+        const auto code = (bits >> cutoffShift) & maxCutoffCode;
+        locks.values[ParameterLocks::cutoff] = juce::mapToLog10(static_cast<float>(code) / static_cast<float>(maxCutoffCode),
+                                                                minCutoff, maxCutoff);
+    }
+
+    for (int target = ParameterLocks::resonance; target < ParameterLocks::numTargets; ++target)
+    {
+        if (!locks.isLocked(static_cast<ParameterLocks::Target>(target)))
+            continue;
+
+        const auto& range = lockRanges[target - ParameterLocks::resonance];
+        const auto code = (bits >> (firstValueShift + 7 * (target - ParameterLocks::resonance))) & maxValueCode;
+        locks.values[target] = range.start + (range.end - range.start) * static_cast<float>(code) / static_cast<float>(maxValueCode);
+    }
+
+    return locks;
+}
+
+void PatternBank::writeTo(juce::OutputStream& output) const
+{
+    output.writeByte(static_cast<char>(selectedPattern));
+    output.writeBool(songMode);
+
+    output.writeByte(static_cast<char>(chain.length));
+
+    for (int i = 0; i < chain.length; ++i)
+    {
+        output.writeByte(static_cast<char>(chain.entries[static_cast<size_t>(i)].pattern));
+        output.writeByte(static_cast<char>(chain.entries[static_cast<size_t>(i)].bars));
+    }
+
+    const SequencerPattern emptyPattern;
+    const auto emptyStepBits = PackedStep().getBits();
+
+    auto getStoredSteps = [&](const SequencerPattern& pattern)
+    {
+        int numSteps = SequencerPattern::maxSteps;
+
+        while (numSteps > 0 && pattern.steps[static_cast<size_t>(numSteps - 1)].getBits() == emptyStepBits)
+            --numSteps;
+
+        return numSteps;
+    };
+
+    auto isStored = [&](const SequencerPattern& pattern)
+    {
+        return pattern.length != emptyPattern.length || getStoredSteps(pattern) > 0;
+    };
+
+    output.writeShort(static_cast<short>(std::count_if(patterns.begin(), patterns.end(), isStored)));
+
+    for (int index = 0; index < numPatterns; ++index)
+    {
+        const auto& pattern = patterns[static_cast<size_t>(index)];
+
+        if (!isStored(pattern))
+            continue;
+
+        const int numSteps = getStoredSteps(pattern);
+
+        output.writeByte(static_cast<char>(index));
+        output.writeByte(static_cast<char>(pattern.length));
+        output.writeByte(static_cast<char>(numSteps));
+
+        for (int step = 0; step < numSteps; ++step)
+            output.writeInt64(static_cast<juce::int64>(pattern.steps[static_cast<size_t>(step)].getBits()));
+    }
+}
+
+bool PatternBank::readFrom(juce::InputStream& input)
+{
+    // Built aside, so a truncated or corrupt bank never half-replaces this one
+    auto bank = std::make_unique<PatternBank>();
+
+    // Streams read zeros past their end, so every read is checked against what is left
+    auto hasBytes = [&input](juce::int64 numBytes) { return input.getNumBytesRemaining() >= numBytes; };
+    auto readByte = [&input]() { return static_cast<int>(static_cast<uint8_t>(input.readByte())); };
+
+    if (!hasBytes(3))
+        return false;
+
+    bank->selectedPattern = readByte();
+    bank->songMode = input.readBool();
+    bank->chain.length = readByte();
+
+    if (bank->selectedPattern >= numPatterns || bank->chain.length > SongChain::maxEntries
+        || !hasBytes(bank->chain.length * 2 + 2))
+        return false;
+
+    for (int i = 0; i < bank->chain.length; ++i)
+    {
+        auto& entry = bank->chain.entries[static_cast<size_t>(i)];
+        entry.pattern = static_cast<uint8_t>(readByte());
+        entry.bars = static_cast<uint8_t>(readByte());
+
+        if (entry.pattern >= numPatterns || entry.bars == 0)
+            return false;
+    }
+
+    const int numStoredPatterns = static_cast<int>(static_cast<uint16_t>(input.readShort()));
+
+    if (numStoredPatterns > numPatterns)
+        return false;
+
+    for (int i = 0; i < numStoredPatterns; ++i)
+    {
+        if (!hasBytes(3))
+            return false;
+
+        const int index = readByte();
+        const int length = readByte();
+        const int numSteps = readByte();
+
+        if (index >= numPatterns || length < 1 || length > SequencerPattern::maxSteps
+            || numSteps > SequencerPattern::maxSteps || !hasBytes(numSteps * 8))
+            return false;
+
+        auto& pattern = bank->patterns[static_cast<size_t>(index)];
+        pattern.length = static_cast<uint8_t>(length);
+
+        for (int step = 0; step < numSteps; ++step)
+            pattern.steps[static_cast<size_t>(step)] = PackedStep::fromBits(static_cast<uint64_t>(input.readInt64()));
+    }
+
+    *this = *bank;
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Synth/ParameterLocks.h"
+
+// One sequencer step as the editor works with it
+struct SequencerStep
+{
+    int noteNumber = 60;
+    float velocity = 0.8f;
+    bool isActive = false;
+    bool hasSlide = false;
+    bool hasAccent = false;
+    bool isChained = false;
+    ParameterLocks locks;
+};
+
+// A step in 64 bits, as stored in the bank and read by the audio thread:
+// note (7) | velocity (7) | active, slide, accent, chained (4) | lock mask (5)
+// | cutoff (13) | resonance, decay, accent, overdrive (7 each).
+// Velocity is kept in MIDI resolution. The cutoff lock is on a log scale from
+// 20 Hz to 20 kHz, under 0.1% per code; the others span their knob's range.
+// Unlocked values are stored as zero, so equal steps have equal bits.
+// A 64-step pattern is 520 bytes and the whole bank about 65 KB.
+class PackedStep
+{
+public:
+    PackedStep() noexcept : PackedStep(SequencerStep {}) {}
+    explicit PackedStep(const SequencerStep& step) noexcept;
+
+    SequencerStep unpack() const noexcept;
+
+    int getNoteNumber() const noexcept { return static_cast<int>(bits & 0x7f); }
+    int getVelocity() const noexcept { return static_cast<int>((bits >> 7) & 0x7f); }
+    bool isActive() const noexcept { return (bits & activeFlag) != 0; }
+    bool hasSlide() const noexcept { return (bits & slideFlag) != 0; }
+    bool hasAccent() const noexcept { return (bits & accentFlag) != 0; }
+    bool isChained() const noexcept { return (bits & chainedFlag) != 0; }
+    bool hasLocks() const noexcept { return ((bits >> lockMaskShift) & lockMaskBits) != 0; }
+    ParameterLocks getLocks() const noexcept;
+
+    uint64_t getBits() const noexcept { return bits; }
+    static PackedStep fromBits(uint64_t newBits) noexcept { PackedStep step; step.bits = newBits; return step; }
+
+private:
+    static constexpr uint64_t activeFlag = 1u << 14;
+    static constexpr uint64_t slideFlag = 1u << 15;
+    static constexpr uint64_t accentFlag = 1u << 16;
+    static constexpr uint64_t chainedFlag = 1u << 17;
+    static constexpr int lockMaskShift = 18;
+    static constexpr uint64_t lockMaskBits = (1u << ParameterLocks::numTargets) - 1;
+    static constexpr int cutoffShift = 23;
+    static constexpr uint64_t maxCutoffCode = (1u << 13) - 1;
+    static constexpr int firstValueShift = 36;   // resonance, then 7 bits per target
+    static constexpr uint64_t maxValueCode = (1u << 7) - 1;
+
+    uint64_t bits { 0 };
+};
+
+static_assert(sizeof(PackedStep) == 8, "a step must pack into 64 bits");
+
+struct SequencerPattern
+{
+    static constexpr int maxSteps = 64;
+
+    std::array<PackedStep, maxSteps> steps;
+    uint8_t length { 16 };
+
+    SequencerStep getStep(int index) const noexcept { return steps[static_cast<size_t>(index)].unpack(); }
+    void setStep(int index, const SequencerStep& step) noexcept { steps[static_cast<size_t>(index)] = PackedStep(step); }
+};
+
+// Song mode plays the entries in order, each for a whole number of bars,
+// and then starts over
+struct SongChain
+{
+    static constexpr int maxEntries = 64;
+
+    struct Entry
+    {
+        uint8_t pattern { 0 };
+        uint8_t bars { 1 };
+    };
+
+    std::array<Entry, maxEntries> entries {};
+    int length { 0 };
+};
+
+// Everything the sequencer plays from, handed to the audio thread as one value
+struct PatternBank
+{
+    static constexpr int numPatterns = 128;
+
+    std::array<SequencerPattern, numPatterns> patterns;
+    SongChain chain;
+    int selectedPattern { 0 };  // plays from the next bar line when song mode is off
+    bool songMode { false };
+
+    // Compact binary form for the plugin state. Only patterns that differ
+    // from an empty one are written, each up to its last non-empty step.
+    void writeTo(juce::OutputStream& output) const;
+
+    // Replaces this bank; returns false, leaving it unchanged, if the data is malformed
+    bool readFrom(juce::InputStream& input);
+};
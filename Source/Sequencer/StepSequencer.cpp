@@ -3,14 +3,21 @@
 StepSequencer::StepSequencer()
 {
     // Initialize with a more obvious pattern - every step active
+    auto& firstPattern = editBank.patterns[0];
+
     for (int i = 0; i < maxSteps; ++i)
     {
-        steps[i].noteNumber = 36 + (i % 12);
-        steps[i].isActive = true;  // All steps active for testing
-        steps[i].velocity = 0.7f;
-        steps[i].cutoffValue = 1000.0f;
+        Step step;
+        step.noteNumber = 36 + (i % 12);
+        step.isActive = true;  // All steps active for testing
+        step.velocity = 0.7f;
+        firstPattern.setStep(i, step);
     }
 
+    // No audio thread yet, so the bank can be taken straight away
+    publishBank();
+    publishedBanks.acquire();
+
     // Initialize timing
     calculateStepLength();
 }
@@ -23,6 +30,7 @@ void StepSequencer::prepareToPlay(double sr, int samplesPerBlock)
 {
     sampleRate = sr;
     calculateStepLength();
+    restartClock();
 }
 
 void StepSequencer::calculateStepLength()
@@ -30,13 +38,53 @@ void StepSequencer::calculateStepLength()
     double beatsPerSecond = currentTempo / 60.0;
     double secondsPerBeat = 1.0 / beatsPerSecond;
     double secondsPerSixteenth = secondsPerBeat / 4.0;
-    samplesPerStep = static_cast<int>(secondsPerSixteenth * sampleRate);
+    samplesPerStep = secondsPerSixteenth * sampleRate;  // kept fractional; boundaries are rounded one by one
+}
+
+void StepSequencer::restartClock()
+{
+    clockSample = 0;
+    anchorSample = 0;
+    anchorStep = 0;
+    anchorPhase = 0.0;
+    nextStep = 0;
+}
+
+void StepSequencer::applyRequestedTempo()
+{
+    const double tempo = requestedTempo.load(std::memory_order_relaxed);
+
+    if (tempo == currentTempo)
+        return;
+
+    // Re-anchor at the current sample, keeping the phase of the step in progress
+    const double position = anchorPhase + static_cast<double>(clockSample - anchorSample) / samplesPerStep;
+    const double wholeSteps = std::floor(position);
+
+    anchorStep += static_cast<juce::int64>(wholeSteps);
+    anchorPhase = position - wholeSteps;
+    anchorSample = clockSample;
+
+    currentTempo = tempo;
+    calculateStepLength();
+}
+
+juce::int64 StepSequencer::getStepStartSample(juce::int64 step) const noexcept
+{
+    // Measured from the anchor rather than accumulated, so rounding never builds up.
+    // A step plays on the first sample at or after its exact start.
+    const double exactStart = (static_cast<double>(step - anchorStep) - anchorPhase) * samplesPerStep;
+    return anchorSample + static_cast<juce::int64>(std::ceil(exactStart - 1.0e-6));
 }
 
 void StepSequencer::processBlock(juce::AudioBuffer<float>& buffer,
                                   juce::MidiBuffer& midiMessages,
                                   juce::AudioPlayHead* playHead)
 {
+    // Edits reach playback whole, at block boundaries
+    publishedBanks.acquire();
+    parameterLocks.clear();
+
     // Check if we should use host transport
     bool useHostTransport = false;
 
@@ -57,43 +105,40 @@ void StepSequencer::processBlock(juce::AudioBuffer<float>& buffer,
                 calculateStepLength();
             }
 
-            double ppqPosition = info.ppqPosition;
-            double ppqPerStep = 0.25;
-            int newStepIndex = static_cast<int>(ppqPosition / ppqPerStep) % patternLength;
-
-            if (newStepIndex != currentStepIndex)
-            {
-                currentStepIndex = newStepIndex;
-                currentSamplePosition = 0;
-                sendNoteEvents(midiMessages, 0);
-            }
+            processHostBlock(info, buffer.getNumSamples(), midiMessages);
+        }
+        else if (hostWasPlaying)
+        {
+            // The host stopped its transport: stop too, so the last note is released below
+            playing = false;
         }
+
+        hostWasPlaying = info.isPlaying;
     }
 
     // Use internal clock if playing manually or host isn't playing
     if (playing && !useHostTransport)
     {
-        int numSamples = buffer.getNumSamples();
-        int samplesProcessed = 0;
+        if (clockRestartPending.exchange(false))
+            restartClock();
 
-        while (samplesProcessed < numSamples)
-        {
-            int samplesThisTime = std::min(numSamples - samplesProcessed,
-                                            samplesPerStep - currentSamplePosition);
+        // Tempo changes take effect exactly at the first sample of the block
+        applyRequestedTempo();
 
-            if (currentSamplePosition == 0)
-            {
-                sendNoteEvents(midiMessages, samplesProcessed);
-            }
+        const int numSamples = buffer.getNumSamples();
+        const juce::int64 blockEnd = clockSample + numSamples;
 
-            currentSamplePosition += samplesThisTime;
-            samplesProcessed += samplesThisTime;
+        for (auto stepStart = getStepStartSample(nextStep); stepStart < blockEnd;
+             stepStart = getStepStartSample(nextStep))
+        {
+            const int offset = static_cast<int>(juce::jmax(juce::int64 { 0 }, stepStart - clockSample));
 
-            if (currentSamplePosition >= samplesPerStep)
-            {
-                moveToNextStep();
-            }
+            beginStep(nextStep);
+            sendNoteEvents(midiMessages, offset);
+            ++nextStep;
         }
+
+        clockSample = blockEnd;
     }
 
     // Handle stopping
@@ -103,21 +148,167 @@ void StepSequencer::processBlock(juce::AudioBuffer<float>& buffer,
         noteIsPlaying = false;
         lastNoteNumber = -1;
     }
+
+    // A stopped sequencer leaves the sound to the knobs
+    if (!playing && locksAreHeld)
+    {
+        parameterLocks.push(0, {});
+        locksAreHeld = false;
+    }
+
+    if (playing != reportedPlaying && guiEvents != nullptr)
+        guiEvents->push(AudioEvent::Type::transport, playing ? 1 : 0, 0);
+
+    reportedPlaying = playing;
+}
+
+void StepSequencer::processHostBlock(const juce::AudioPlayHead::CurrentPositionInfo& info,
+                                     int numSamples, juce::MidiBuffer& midiMessages)
+{
+    // The host reports one tempo per block, so a tempo ramp is followed block by block
+    const double samplesPerPpq = sampleRate * 60.0 / currentTempo;
+    const double ppqPerSample = 1.0 / samplesPerPpq;
+    const double blockEndPpq = info.ppqPosition + numSamples * ppqPerSample;
+
+    // A start, relocation or loop jump restarts the step bookkeeping
+    if (!hostWasPlaying || std::abs(info.ppqPosition - expectedHostPpq) > ppqPerSample)
+        lastHostStep = noStep;
+
+    if (info.isLooping && info.ppqLoopEnd > info.ppqLoopStart
+        && info.ppqPosition < info.ppqLoopEnd && blockEndPpq > info.ppqLoopEnd)
+    {
+        // The loop wraps inside this block: play up to the loop end, then on from the loop start
+        const int wrapOffset = juce::jlimit(0, numSamples,
+            static_cast<int>(std::ceil((info.ppqLoopEnd - info.ppqPosition) * samplesPerPpq - 1.0e-6)));
+
+        scheduleHostSteps(info.ppqPosition, samplesPerPpq, 0, wrapOffset, midiMessages);
+
+        lastHostStep = noStep;
+        scheduleHostSteps(info.ppqLoopStart, samplesPerPpq, wrapOffset, numSamples, midiMessages);
+        expectedHostPpq = info.ppqLoopStart + (numSamples - wrapOffset) * ppqPerSample;
+    }
+    else
+    {
+        scheduleHostSteps(info.ppqPosition, samplesPerPpq, 0, numSamples, midiMessages);
+        expectedHostPpq = blockEndPpq;
+    }
 }
 
-void StepSequencer::moveToNextStep()
+void StepSequencer::scheduleHostSteps(double ppqAtStart, double samplesPerPpq,
+                                      int startOffset, int endOffset, juce::MidiBuffer& midiMessages)
 {
-    currentStepIndex = (currentStepIndex + 1) % patternLength;
-    currentSamplePosition = 0;
+    // Each boundary plays on the first sample at or after it, so the first
+    // sample of the segment owns every boundary in the sample before it
+    constexpr double epsilon = 1.0e-6;
+    auto step = static_cast<juce::int64>(std::floor((ppqAtStart - (1.0 - epsilon) / samplesPerPpq) / ppqPerStep)) + 1;
+
+    if (lastHostStep != noStep)
+        step = juce::jmax(step, lastHostStep + 1);
+
+    for (;; ++step)
+    {
+        const double samplesUntilStep = (static_cast<double>(step) * ppqPerStep - ppqAtStart) * samplesPerPpq;
+        const int offset = startOffset + juce::jmax(0, static_cast<int>(std::ceil(samplesUntilStep - epsilon)));
+
+        if (offset >= endOffset)
+            break;
+
+        beginStep(step);
+        sendNoteEvents(midiMessages, offset);
+        lastHostStep = step;
+    }
+}
+
+void StepSequencer::beginStep(juce::int64 step) noexcept
+{
+    const auto& bank = getPlayingBank();
+    const bool songMode = bank.songMode && bank.chain.length > 0;
+
+    if (step != lastPlayedStep + 1 || songMode != followingChain)
+    {
+        // Start, relocation, loop or mode change: find the place from scratch
+        followingChain = songMode;
+        locateInSong(step);
+    }
+    else if (step % stepsPerBar == 0)
+    {
+        // Bar line: the only place the playing pattern changes
+        if (followingChain)
+        {
+            chainEntry = juce::jmin(chainEntry, bank.chain.length - 1);
+
+            // Entries of zero bars are skipped
+            for (int skipped = 0; skipped < bank.chain.length
+                 && step - chainEntryStart >= bank.chain.entries[static_cast<size_t>(chainEntry)].bars * stepsPerBar;
+                 ++skipped)
+            {
+                chainEntry = (chainEntry + 1) % bank.chain.length;
+                chainEntryStart = step;
+            }
+
+            playingPatternIndex = bank.chain.entries[static_cast<size_t>(chainEntry)].pattern % numPatterns;
+        }
+        else
+        {
+            playingPatternIndex = bank.selectedPattern;
+        }
+    }
+
+    lastPlayedStep = step;
+
+    // Song entries play their pattern from its start; otherwise the pattern follows the timeline
+    const int length = juce::jmax(1, static_cast<int>(getPlayingPattern().length));
+    const auto patternStep = followingChain ? step - chainEntryStart : step;
+    currentStepIndex = static_cast<int>(((patternStep % length) + length) % length);
+}
+
+void StepSequencer::locateInSong(juce::int64 step) noexcept
+{
+    const auto& bank = getPlayingBank();
+
+    if (!followingChain)
+    {
+        playingPatternIndex = bank.selectedPattern;
+        return;
+    }
+
+    juce::int64 songSteps = 0;
+
+    for (int i = 0; i < bank.chain.length; ++i)
+        songSteps += bank.chain.entries[static_cast<size_t>(i)].bars * stepsPerBar;
+
+    // An entry of zero bars is skipped; a chain of nothing but those plays its first entry
+    chainEntry = 0;
+    chainEntryStart = step - ((step % stepsPerBar) + stepsPerBar) % stepsPerBar;
+
+    if (songSteps > 0)
+    {
+        auto position = ((step % songSteps) + songSteps) % songSteps;
+        chainEntryStart = step - position;
+
+        while (position >= bank.chain.entries[static_cast<size_t>(chainEntry)].bars * stepsPerBar)
+        {
+            const auto entrySteps = bank.chain.entries[static_cast<size_t>(chainEntry)].bars * stepsPerBar;
+            position -= entrySteps;
+            chainEntryStart += entrySteps;
+            ++chainEntry;
+        }
+    }
+
+    playingPatternIndex = bank.chain.entries[static_cast<size_t>(chainEntry)].pattern % numPatterns;
 }
 
 void StepSequencer::sendNoteEvents(juce::MidiBuffer& midiMessages, int samplePosition)
 {
-    const Step& currentStep = steps[currentStepIndex];
+    const auto& pattern = getPlayingPattern();
+    const auto currentStep = pattern.steps[static_cast<size_t>(currentStepIndex)];
 
-    if (!currentStep.isActive)
+    if (guiEvents != nullptr)
+        guiEvents->push(AudioEvent::Type::stepAdvance, currentStepIndex, samplePosition);
+
+    if (!currentStep.isActive())
     {
-        if (noteIsPlaying && lastNoteNumber >= 0 && !currentStep.isChained)
+        if (noteIsPlaying && lastNoteNumber >= 0 && !currentStep.isChained())
         {
             midiMessages.addEvent(juce::MidiMessage::noteOff(1, lastNoteNumber), samplePosition);
             noteIsPlaying = false;
@@ -126,21 +317,19 @@ void StepSequencer::sendNoteEvents(juce::MidiBuffer& midiMessages, int samplePos
         return;
     }
 
-    if (!currentStep.isChained && noteIsPlaying && lastNoteNumber >= 0)
+    if (!currentStep.isChained() && noteIsPlaying && lastNoteNumber >= 0)
     {
         midiMessages.addEvent(juce::MidiMessage::noteOff(1, lastNoteNumber), samplePosition);
         noteIsPlaying = false;
     }
 
-    float velocity = currentStep.hasAccent ? 1.0f : currentStep.velocity;
-    velocity = juce::jlimit(0.0f, 1.0f, velocity);
-
-    int velocityInt = static_cast<int>(velocity * 127.0f);
+    // Velocity is stored in MIDI resolution already
+    const int velocityInt = currentStep.hasAccent() ? 127 : currentStep.getVelocity();
 
-    if (currentStep.hasSlide && currentStepIndex < patternLength - 1)
+    if (currentStep.hasSlide() && currentStepIndex < pattern.length - 1)
     {
-        const Step& nextStep = steps[(currentStepIndex + 1) % patternLength];
-        if (nextStep.isActive)
+        const auto followingStep = pattern.steps[static_cast<size_t>((currentStepIndex + 1) % pattern.length)];
+        if (followingStep.isActive())
         {
             midiMessages.addEvent(
                 juce::MidiMessage::controllerEvent(1, 65, 127), samplePosition);
@@ -148,44 +337,115 @@ void StepSequencer::sendNoteEvents(juce::MidiBuffer& midiMessages, int samplePos
     }
 
     midiMessages.addEvent(
-        juce::MidiMessage::noteOn(1, currentStep.noteNumber, (juce::uint8)velocityInt),
+        juce::MidiMessage::noteOn(1, currentStep.getNoteNumber(), (juce::uint8)velocityInt),
         samplePosition);
 
     noteIsPlaying = true;
-    lastNoteNumber = currentStep.noteNumber;
+    lastNoteNumber = currentStep.getNoteNumber();
 
-    if (onStepCutoffChange)
-    {
-        onStepCutoffChange(currentStepIndex, currentStep.cutoffValue);
-    }
+    // Every played step sends its locks, so a step without any hands the
+    // parameters back to the knobs
+    if (currentStep.hasLocks() || locksAreHeld)
+        parameterLocks.push(samplePosition, currentStep.getLocks());
+
+    locksAreHeld = currentStep.hasLocks();
 }
 
 void StepSequencer::setStep(int stepIndex, const Step& step)
 {
+    const juce::ScopedLock lock(editLock);
     if (stepIndex >= 0 && stepIndex < maxSteps)
     {
-        steps[stepIndex] = step;
+        stageStep(stepIndex, step);
+        publishBank();
     }
 }
 
+void StepSequencer::stageStep(int stepIndex, const Step& step)
+{
+    const juce::ScopedLock lock(editLock);
+    if (stepIndex >= 0 && stepIndex < maxSteps)
+        editBank.patterns[static_cast<size_t>(editBank.selectedPattern)].setStep(stepIndex, step);
+}
+
 StepSequencer::Step StepSequencer::getStep(int stepIndex) const
 {
     if (stepIndex >= 0 && stepIndex < maxSteps)
     {
-        return steps[stepIndex];
+        return getPattern().getStep(stepIndex);
     }
     return Step();
 }
 
 void StepSequencer::setPatternLength(int length)
 {
-    patternLength = juce::jlimit(1, maxSteps, length);
+    const juce::ScopedLock lock(editLock);
+    auto& pattern = editBank.patterns[static_cast<size_t>(editBank.selectedPattern)];
+    pattern.length = static_cast<uint8_t>(juce::jlimit(1, maxSteps, length));
+    publishBank();
+}
+
+void StepSequencer::setPattern(const Pattern& newPattern)
+{
+    const juce::ScopedLock lock(editLock);
+    auto& pattern = editBank.patterns[static_cast<size_t>(editBank.selectedPattern)];
+    pattern = newPattern;
+    pattern.length = static_cast<uint8_t>(juce::jlimit(1, maxSteps, static_cast<int>(pattern.length)));
+    publishBank();
+}
+
+void StepSequencer::selectPattern(int patternIndex)
+{
+    const juce::ScopedLock lock(editLock);
+    editBank.selectedPattern = juce::jlimit(0, numPatterns - 1, patternIndex);
+    publishBank();
+}
+
+void StepSequencer::setSongChain(const SongChain& newChain)
+{
+    const juce::ScopedLock lock(editLock);
+    editBank.chain = newChain;
+    editBank.chain.length = juce::jlimit(0, SongChain::maxEntries, editBank.chain.length);
+    publishBank();
+}
+
+void StepSequencer::setSongMode(bool shouldFollowChain)
+{
+    const juce::ScopedLock lock(editLock);
+    editBank.songMode = shouldFollowChain;
+    publishBank();
+}
+
+void StepSequencer::setBank(const PatternBank& newBank)
+{
+    const juce::ScopedLock lock(editLock);
+    editBank = newBank;
+    editBank.selectedPattern = juce::jlimit(0, numPatterns - 1, editBank.selectedPattern);
+    editBank.chain.length = juce::jlimit(0, SongChain::maxEntries, editBank.chain.length);
+
+    for (auto& pattern : editBank.patterns)
+        pattern.length = static_cast<uint8_t>(juce::jlimit(1, maxSteps, static_cast<int>(pattern.length)));
+
+    publishBank();
+}
+
+void StepSequencer::copyBank(PatternBank& destination) const
+{
+    const juce::ScopedLock lock(editLock);
+    destination = editBank;
+}
+
+void StepSequencer::publishBank()
+{
+    const juce::ScopedLock lock(editLock);
+    publishedBanks.getWriteBuffer() = editBank;
+    publishedBanks.publish();
 }
 
 void StepSequencer::setTempo(double bpm)
 {
-    currentTempo = juce::jlimit(60.0, 200.0, bpm);
-    calculateStepLength();
+    // Picked up by the audio thread at the start of its next block
+    requestedTempo.store(juce::jlimit(60.0, 200.0, bpm), std::memory_order_relaxed);
 }
 
 void StepSequencer::setPlaying(bool shouldPlay)
@@ -202,7 +462,6 @@ void StepSequencer::setPlaying(bool shouldPlay)
     if (playing)
     {
         currentStepIndex = 0;
-        currentSamplePosition = 0;
-        calculateStepLength();  // Ensure timing is set
+        clockRestartPending.store(true);  // the audio thread restarts from step 0 at its next block
     }
 }
\ No newline at end of file
@@ -1,20 +1,19 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../Utility/TripleBuffer.h"
+#include "../Utility/AudioEventFifo.h"
+#include "PatternBank.h"
 
 class StepSequencer
 {
 public:
-    struct Step
-    {
-        int noteNumber = 60;
-        float velocity = 0.8f;
-        bool isActive = false;
-        bool hasSlide = false;
-        bool hasAccent = false;
-        bool isChained = false;
-        float cutoffValue = 1000.0f;
-    };
+    using Step = SequencerStep;
+    using Pattern = SequencerPattern;
+
+    static constexpr int maxSteps = SequencerPattern::maxSteps;
+    static constexpr int numPatterns = PatternBank::numPatterns;
+    static constexpr int stepsPerBar = 16;
 
     StepSequencer();
     ~StepSequencer();
@@ -23,42 +22,135 @@ public:
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages,
                       juce::AudioPlayHead* playHead);
 
+    // Bank editing, normally from the message thread. Changes hold a lock,
+    // so a host restoring state from another thread is safe too. Reads come
+    // from the editor's own copy; every change publishes the whole bank
+    // (about 65 KB), which the audio thread picks up at its next block. Step
+    // and pattern calls act on the selected pattern.
     void setStep(int stepIndex, const Step& step);
     Step getStep(int stepIndex) const;
 
+    // For continuous gestures such as slider drags: changes the step in the
+    // editor's copy only, so the bank is copied once when the gesture ends
+    // with publishEdits() rather than on every move
+    void stageStep(int stepIndex, const Step& step);
+    void publishEdits() { publishBank(); }
+
+    // Replaces every step in one change, so playback never mixes old and new steps
+    void setPattern(const Pattern& newPattern);
+    const Pattern& getPattern() const { return editBank.patterns[static_cast<size_t>(editBank.selectedPattern)]; }
+
     void setPatternLength(int length);
-    int getPatternLength() const { return patternLength; }
+    int getPatternLength() const { return getPattern().length; }
+
+    // Outside song mode the selected pattern starts playing at the next bar line
+    void selectPattern(int patternIndex);
+    int getSelectedPattern() const { return editBank.selectedPattern; }
 
+    // Song mode follows the chain, switching patterns on bar lines
+    void setSongChain(const SongChain& newChain);
+    const SongChain& getSongChain() const { return editBank.chain; }
+    void setSongMode(bool shouldFollowChain);
+    bool isSongMode() const { return editBank.songMode; }
+
+    const PatternBank& getBank() const { return editBank; }
+
+    // Any thread: a consistent copy of the bank, e.g. for hosts that save
+    // state off the message thread
+    void copyBank(PatternBank& destination) const;
+    void setBank(const PatternBank& newBank);
+
+    // Internal clock tempo; applied at the start of the next audio block
     void setTempo(double bpm);
     double getTempo() const { return currentTempo; }
+    double getInternalTempo() const { return requestedTempo.load(std::memory_order_relaxed); }
+
+    // Length of one step of the clock that is driving playback right now
+    double getSamplesPerStep() const { return samplesPerStep; }
 
     bool isPlaying() const { return playing; }
     void setPlaying(bool shouldPlay);
 
     int getCurrentStep() const { return currentStepIndex; }
 
-    std::function<void(int, float)> onStepCutoffChange;
+    // Audio thread: the lock changes of the steps played in the last
+    // processBlock() call, stamped with their sample offsets
+    const ParameterLockQueue& getParameterLocks() const noexcept { return parameterLocks; }
+
+    // Step advances and transport changes are reported here, if set
+    void setGuiEvents(AudioEventFifo* fifo) { guiEvents = fifo; }
 
 private:
-    static constexpr int maxSteps = 16;
+    static constexpr double ppqPerStep = 0.25;  // sixteenth notes
+
+    PatternBank editBank;                    // message thread
+    juce::CriticalSection editLock;          // held while editBank changes or is copied
+    TripleBuffer<PatternBank> publishedBanks; // message thread -> audio thread
+
+    void publishBank();
 
-    std::array<Step, maxSteps> steps;
-    int patternLength { 16 };
+    // Audio thread: where playback is in the bank. Steps normally arrive one
+    // after another and cost O(1); only a jump in the timeline rescans the chain.
+    static constexpr juce::int64 noStep = std::numeric_limits<juce::int64>::min();
+    juce::int64 lastPlayedStep { noStep };
+    int playingPatternIndex { 0 };
+    int chainEntry { 0 };
+    juce::int64 chainEntryStart { 0 };   // absolute step where the current chain entry began
+    bool followingChain { false };
+
+    const PatternBank& getPlayingBank() const noexcept { return publishedBanks.getReadBuffer(); }
+    const Pattern& getPlayingPattern() const noexcept
+    {
+        return getPlayingBank().patterns[static_cast<size_t>(playingPatternIndex)];
+    }
+
+    void beginStep(juce::int64 step) noexcept;
+    void locateInSong(juce::int64 step) noexcept;
 
     double sampleRate { 44100.0 };
-    double currentTempo { 120.0 };
+    std::atomic<double> currentTempo { 120.0 };
+    std::atomic<double> requestedTempo { 120.0 };
 
     int currentStepIndex { 0 };
-    int samplesPerStep { 0 };
-    int currentSamplePosition { 0 };
+    double samplesPerStep { 0.0 };
+
+    // Internal clock. Step boundaries are computed from the last tempo
+    // change (the anchor) with a 64-bit sample counter, so the clock never
+    // drifts however long it runs.
+    juce::int64 clockSample { 0 };     // samples since playback started
+    juce::int64 anchorSample { 0 };    // clock sample where the current tempo took effect
+    juce::int64 anchorStep { 0 };      // whole steps completed at the anchor
+    double anchorPhase { 0.0 };        // fraction of the next step completed at the anchor
+    juce::int64 nextStep { 0 };        // absolute number of the next step to play
+    std::atomic<bool> clockRestartPending { false };
 
     bool playing { false };
     bool manualMode { false };
     bool noteIsPlaying { false };
     int lastNoteNumber { -1 };
 
+    ParameterLockQueue parameterLocks;
+
+    AudioEventFifo* guiEvents { nullptr };
+    bool reportedPlaying { false };
+    bool locksAreHeld { false };   // the last locks sent are still in force
+
+    // Host transport: absolute step number of the last boundary played and
+    // where the next block should start if the timeline runs on
+    juce::int64 lastHostStep { noStep };
+    double expectedHostPpq { 0.0 };
+    bool hostWasPlaying { false };
+
     void calculateStepLength();
-    void moveToNextStep();
+    void restartClock();
+    void applyRequestedTempo();
+    juce::int64 getStepStartSample(juce::int64 step) const noexcept;
+
+    // Plays every step boundary inside the block at its exact sample offset
+    void processHostBlock(const juce::AudioPlayHead::CurrentPositionInfo& info,
+                          int numSamples, juce::MidiBuffer& midiMessages);
+    void scheduleHostSteps(double ppqAtStart, double samplesPerPpq,
+                           int startOffset, int endOffset, juce::MidiBuffer& midiMessages);
     void sendNoteEvents(juce::MidiBuffer& midiMessages, int samplePosition);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StepSequencer)
@@ -0,0 +1,99 @@
+#include "AcidLadderFilter.h"
+#include "../DSP/FastTanh.h"
+
+AcidLadderFilter::AcidLadderFilter()
+{
+    setDrive(1.2f);
+    setResonance(0.0f);
+    scaledResonance = targetScaledResonance;
+}
+
+void AcidLadderFilter::prepare(double sr)
+{
+    sampleRate = sr;
+    cutoffScaler = static_cast<float>(-juce::MathConstants<double>::twoPi / sampleRate);
+    reset();
+}
+
+void AcidLadderFilter::reset()
+{
+    std::fill(std::begin(state), std::end(state), 0.0f);
+    poleCoefficient = std::exp(1000.0f * cutoffScaler);
+    scaledResonance = targetScaledResonance;
+}
+
+void AcidLadderFilter::setControlInterval(int numSamples) noexcept
+{
+    controlInterval = juce::jmax(1, numSamples);
+}
+
+void AcidLadderFilter::setResonance(float newResonance) noexcept
+{
+    targetScaledResonance = juce::jmap(juce::jlimit(0.0f, 1.0f, newResonance), 0.1f, 1.0f);
+}
+
+void AcidLadderFilter::setDrive(float newDrive) noexcept
+{
+    drive = newDrive;
+    gain = std::pow(drive, -2.642f) * 0.6103f + 0.3903f;
+    drive2 = drive * 0.04f + 0.96f;
+    gain2 = std::pow(drive2, -2.642f) * 0.6103f + 0.3903f;
+}
+
+void AcidLadderFilter::process(float* samples, const float* cutoffHz, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    // Resonance glides across the block instead of stepping
+    const float resonanceStep = (targetScaledResonance - scaledResonance) / static_cast<float>(numSamples);
+
+    float s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3], s4 = state[4];
+
+    for (int start = 0; start < numSamples; start += controlInterval)
+    {
+        const int segmentLength = juce::jmin(controlInterval, numSamples - start);
+
+        // One exp() per segment, linear interpolation of the pole inside it
+        const float fc = juce::jlimit(20.0f, 20000.0f, cutoffHz[start + segmentLength - 1]);
+        const float targetPole = std::exp(fc * cutoffScaler);
+        const float poleStep = (targetPole - poleCoefficient) / static_cast<float>(segmentLength);
+
+        for (int i = start; i < start + segmentLength; ++i)
+        {
+            poleCoefficient += poleStep;
+            scaledResonance += resonanceStep;
+
+            const float a1 = poleCoefficient;
+            const float g = 1.0f - a1;
+            const float b0 = g * 0.76923076923f;
+            const float b1 = g * 0.23076923076f;
+
+            const float dx = gain * FastTanh::tanh(drive * samples[i]);
+            const float a = dx + scaledResonance * -4.0f * (gain2 * FastTanh::tanh(drive2 * s4) - dx * compensation);
+
+            const float b = b1 * s0 + a1 * s1 + b0 * a;
+            const float c = b1 * s1 + a1 * s2 + b0 * b;
+            const float d = b1 * s2 + a1 * s3 + b0 * c;
+            const float e = b1 * s3 + a1 * s4 + b0 * d;
+
+            s0 = a;
+            s1 = b;
+            s2 = c;
+            s3 = d;
+            s4 = e;
+
+            samples[i] = e;
+        }
+
+        poleCoefficient = targetPole;
+    }
+
+    scaledResonance = targetScaledResonance;
+
+    state[0] = s0;
+    state[1] = s1;
+    state[2] = s2;
+    state[3] = s3;
+    state[4] = s4;
+}
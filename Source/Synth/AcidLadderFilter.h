@@ -0,0 +1,47 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Voice-owned 24 dB/oct ladder low-pass with audio-rate cutoff modulation.
+//
+// Same topology and saturation as dsp::LadderFilter in LPF24 mode, but the
+// cutoff comes in as a per-sample buffer. The exp() coefficient mapping is
+// evaluated once per control interval and the pole coefficient is linearly
+// interpolated in between, so envelope sweeps reach the filter sample by
+// sample without per-sample coefficient setters.
+class AcidLadderFilter
+{
+public:
+    AcidLadderFilter();
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // Samples between exp() evaluations; 1 gives exact per-sample coefficients
+    void setControlInterval(int numSamples) noexcept;
+
+    void setResonance(float newResonance) noexcept;
+    void setDrive(float newDrive) noexcept;
+
+    // Filters samples in place; cutoffHz holds one cutoff frequency per sample
+    void process(float* samples, const float* cutoffHz, int numSamples) noexcept;
+
+private:
+    double sampleRate { 44100.0 };
+    float cutoffScaler { 0.0f };
+
+    int controlInterval { 8 };
+
+    // Pole coefficient exp(-2*pi*fc/fs) at the end of the previous control segment
+    float poleCoefficient { 0.0f };
+
+    float scaledResonance { 0.0f };
+    float targetScaledResonance { 0.0f };
+
+    float drive { 1.2f }, gain { 1.0f }, drive2 { 1.0f }, gain2 { 1.0f };
+    static constexpr float compensation = 0.5f;
+
+    float state[5] {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AcidLadderFilter)
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Sound parameters a sequencer step can lock for its own note. A locked
+// value overrides the panel knob from the step's first sample until the next
+// step plays; unlocked parameters follow the knobs.
+struct ParameterLocks
+{
+    enum Target { cutoff = 0, resonance, decay, accent, overdrive, numTargets };
+
+    uint8_t mask { 0 };
+    float values[numTargets] {};
+
+    bool isLocked(Target target) const noexcept { return (mask & (1u << target)) != 0; }
+    bool isEmpty() const noexcept { return mask == 0; }
+
+    void lock(Target target, float value) noexcept
+    {
+        mask = static_cast<uint8_t>(mask | (1u << target));
+        values[target] = value;
+    }
+
+    void unlock(Target target) noexcept
+    {
+        mask = static_cast<uint8_t>(mask & ~(1u << target));
+        values[target] = 0.0f;
+    }
+
+    float apply(Target target, float knobValue) const noexcept
+    {
+        return isLocked(target) ? values[target] : knobValue;
+    }
+};
+
+struct ParameterLockEvent
+{
+    int samplePosition { 0 };
+    ParameterLocks locks;
+};
+
+// One block's lock changes, in sample order. The storage is fixed, so the
+// sequencer can fill it on the audio thread without allocating.
+class ParameterLockQueue
+{
+public:
+    // The sequencer queues one event per played step, so a block fills the
+    // queue only when its steps are shorter than blockSize / 256 samples:
+    // 32 samples for an 8192-sample block, a 16th note at over 20000 BPM at 48 kHz
+    static constexpr int capacity = 256;
+
+    ParameterLockQueue() = default;
+
+    void clear() noexcept { numEvents = 0; }
+
+    void push(int samplePosition, const ParameterLocks& locks) noexcept
+    {
+        // Kept sorted; an event can never take effect before one already queued
+        if (numEvents > 0)
+            samplePosition = juce::jmax(samplePosition, events[static_cast<size_t>(numEvents - 1)].samplePosition);
+
+        // Only an absurd host tempo can fill the queue. If it does, the newest
+        // locks replace the last queued ones, and the loss is counted.
+        if (numEvents == capacity)
+        {
+            jassertfalse;
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            --numEvents;
+        }
+
+        events[static_cast<size_t>(numEvents++)] = { samplePosition, locks };
+    }
+
+    int size() const noexcept { return numEvents; }
+
+    // Events overwritten because the queue was full, since construction; safe
+    // to call from any thread
+    int getNumDroppedEvents() const noexcept { return droppedEvents.load(std::memory_order_relaxed); }
+    const ParameterLockEvent& operator[](int index) const noexcept { return events[static_cast<size_t>(index)]; }
+
+private:
+    std::array<ParameterLockEvent, capacity> events;
+    int numEvents { 0 };
+    std::atomic<int> droppedEvents { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterLockQueue)
+};
+
+// A voice's read position in the current block's queue
+class ParameterLockCursor
+{
+public:
+    void begin(const ParameterLockQueue& newQueue) noexcept
+    {
+        queue = &newQueue;
+        nextEvent = 0;
+    }
+
+    // Sample of the next event not yet taken, or INT_MAX when there is none
+    int getNextPosition() const noexcept
+    {
+        return queue != nullptr && nextEvent < queue->size() ? (*queue)[nextEvent].samplePosition
+                                                             : std::numeric_limits<int>::max();
+    }
+
+    // Takes every event at or before samplePosition; returns true if locks changed
+    bool advanceTo(int samplePosition, ParameterLocks& locks) noexcept
+    {
+        bool changed = false;
+
+        while (queue != nullptr && nextEvent < queue->size()
+               && (*queue)[nextEvent].samplePosition <= samplePosition)
+        {
+            locks = (*queue)[nextEvent++].locks;
+            changed = true;
+        }
+
+        return changed;
+    }
+
+private:
+    const ParameterLockQueue* queue { nullptr };
+    int nextEvent { 0 };
+};
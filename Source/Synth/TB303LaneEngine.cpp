@@ -0,0 +1,357 @@
+#include "TB303LaneEngine.h"
+#include "TB303Synth.h"
+#include "../DSP/FastTanh.h"
+
+// TB303LaneEngine Implementation
+TB303LaneEngine::TB303LaneEngine()
+{
+    ladderGain = std::pow(ladderDrive, -2.642f) * 0.6103f + 0.3903f;
+    ladderDrive2 = ladderDrive * 0.04f + 0.96f;
+    ladderGain2 = std::pow(ladderDrive2, -2.642f) * 0.6103f + 0.3903f;
+}
+
+void TB303LaneEngine::prepare(double sr, int)
+{
+    sampleRate = sr;
+    cutoffScaler = static_cast<float>(-juce::MathConstants<double>::twoPi / sampleRate);
+    attackIncrement = static_cast<float>(1.0 / (0.001 * sampleRate));
+    reset();
+}
+
+void TB303LaneEngine::reset()
+{
+    const float defaultIncrement = static_cast<float>(440.0 / sampleRate);
+
+    for (int l = 0; l < maxLanes; ++l)
+    {
+        phase[l] = 0.0f;
+        phaseIncrement[l] = defaultIncrement;
+        WavetableOscillator::selectTables(*wavetable, shape, defaultIncrement,
+                                          lowerTable[l], upperTable[l], tableBlend[l]);
+
+        ampLevel[l] = ampSlope[l] = 0.0f;
+        filterLevel[l] = filterSlope[l] = 0.0f;
+        accentGain[l] = 1.0f;
+
+        pole[l] = std::exp(baseCutoff * cutoffScaler);
+        poleStep[l] = 0.0f;
+        s0[l] = s1[l] = s2[l] = s3[l] = s4[l] = 0.0f;
+    }
+}
+
+void TB303LaneEngine::setNumLanes(int newNumLanes) noexcept
+{
+    numLanes = juce::jlimit(1, maxLanes, newNumLanes);
+    numActiveGroupLanes = ((numLanes + laneWidth - 1) / laneWidth) * laneWidth;
+    laneGain = 1.0f / std::sqrt(static_cast<float>(numLanes));
+
+    // Lanes that dropped out of the layout fall silent immediately
+    for (int l = numLanes; l < maxLanes; ++l)
+        ampLevel[l] = ampSlope[l] = 0.0f;
+}
+
+void TB303LaneEngine::setParameters(float cutoff, float resonance, float decay,
+                                    float accent, float overdrive, Shape newShape) noexcept
+{
+    baseCutoff = cutoff;
+    scaledResonance = juce::jmap(juce::jlimit(0.0f, 1.0f, resonance), 0.1f, 1.0f);
+    accentAmount = accent;
+
+    drive = 1.0f + overdrive * 9.0f;
+    driveGain = 1.0f / std::tanh(drive);
+
+    ampReleaseSamples = juce::jmax(1.0f, static_cast<float>(decay * sampleRate));
+    filterReleaseSamples = juce::jmax(1.0f, static_cast<float>(decay * 0.8f * sampleRate));
+    filterDecayDecrement = 1.0f / filterReleaseSamples;
+
+    if (shape != newShape)
+    {
+        shape = newShape;
+
+        for (int l = 0; l < maxLanes; ++l)
+            WavetableOscillator::selectTables(*wavetable, shape, phaseIncrement[l],
+                                              lowerTable[l], upperTable[l], tableBlend[l]);
+    }
+
+    oscillatorGain = shape == Shape::square ? squareWaveBoost : 1.0f;
+}
+
+void TB303LaneEngine::noteOn(int lane, float frequency, bool accented) noexcept
+{
+    jassert(lane >= 0 && lane < numLanes);
+
+    phase[lane] = 0.0f;
+    phaseIncrement[lane] = static_cast<float>(frequency / sampleRate);
+    WavetableOscillator::selectTables(*wavetable, shape, phaseIncrement[lane],
+                                      lowerTable[lane], upperTable[lane], tableBlend[lane]);
+
+    // Both envelopes restart their attack from the current level, like juce::ADSR
+    ampSlope[lane] = attackIncrement;
+    filterSlope[lane] = attackIncrement;
+    accentGain[lane] = accented ? 1.0f + accentAmount : 1.0f;
+}
+
+void TB303LaneEngine::noteOff(int lane) noexcept
+{
+    jassert(lane >= 0 && lane < maxLanes);
+
+    // Linear release from the current level, like juce::ADSR
+    ampSlope[lane] = -ampLevel[lane] / ampReleaseSamples;
+    filterSlope[lane] = -filterLevel[lane] / filterReleaseSamples;
+}
+
+bool TB303LaneEngine::isAnyLaneActive() const noexcept
+{
+    for (int l = 0; l < numLanes; ++l)
+        if (ampLevel[l] > 0.0f || ampSlope[l] > 0.0f)
+            return true;
+
+    return false;
+}
+
+void TB303LaneEngine::render(float* output, int numSamples) noexcept
+{
+    using Lanes = juce::dsp::SIMDRegister<float>;
+
+    const int lanes = numActiveGroupLanes;
+
+    const auto zero = Lanes::expand(0.0f);
+    const auto one = Lanes::expand(1.0f);
+    const auto ladderInputScale = Lanes::expand(0.76923076923f);
+    const auto ladderStateScale = Lanes::expand(0.23076923076f);
+    const auto feedback = Lanes::expand(scaledResonance * -4.0f);
+
+    for (int start = 0; start < numSamples; start += controlInterval)
+    {
+        const int segmentLength = juce::jmin(controlInterval, numSamples - start);
+        const float segmentScale = 1.0f / static_cast<float>(segmentLength);
+
+        // Control rate: end filter attacks, and derive each lane's cutoff from
+        // its filter envelope and accent
+        for (int l = 0; l < lanes; ++l)
+        {
+            if (filterSlope[l] > 0.0f && filterLevel[l] >= 1.0f)
+                filterSlope[l] = -filterDecayDecrement;
+
+            const float fc = juce::jlimit(20.0f, 20000.0f,
+                                          baseCutoff * (1.0f + filterLevel[l] * 4.0f) * accentGain[l]);
+            poleStep[l] = (std::exp(fc * cutoffScaler) - pole[l]) * segmentScale;
+        }
+
+        for (int i = start; i < start + segmentLength; ++i)
+        {
+            // Oscillators: the only per-lane gather
+            for (int l = 0; l < lanes; ++l)
+            {
+                laneFrame[l] = WavetableOscillator::readTables(lowerTable[l], upperTable[l],
+                                                               tableBlend[l], phase[l]) * oscillatorGain;
+                phase[l] += phaseIncrement[l];
+                if (phase[l] >= 1.0f)
+                    phase[l] -= 1.0f;
+            }
+
+            // Ladder input and feedback saturation for all lanes at once
+            FastTanh::shapeTanh(ladderInput, laneFrame, lanes, ladderDrive, ladderGain);
+            FastTanh::shapeTanh(ladderFeedback, s4, lanes, ladderDrive2, ladderGain2);
+
+            // Envelopes and ladder stages, one SIMD register of lanes at a time
+            for (int g = 0; g < lanes; g += laneWidth)
+            {
+                const auto amp = Lanes::min(one, Lanes::max(zero, Lanes::fromRawArray(ampLevel + g)
+                                                                 + Lanes::fromRawArray(ampSlope + g)));
+                amp.copyToRawArray(ampLevel + g);
+
+                const auto filterEnv = Lanes::min(one, Lanes::max(zero, Lanes::fromRawArray(filterLevel + g)
+                                                                       + Lanes::fromRawArray(filterSlope + g)));
+                filterEnv.copyToRawArray(filterLevel + g);
+
+                const auto a1 = Lanes::fromRawArray(pole + g) + Lanes::fromRawArray(poleStep + g);
+                a1.copyToRawArray(pole + g);
+
+                const auto gain = one - a1;
+                const auto b0 = gain * ladderInputScale;
+                const auto b1 = gain * ladderStateScale;
+
+                const auto dx = Lanes::fromRawArray(ladderInput + g);
+                const auto fb = Lanes::fromRawArray(ladderFeedback + g);
+
+                const auto x0 = Lanes::fromRawArray(s0 + g);
+                const auto x1 = Lanes::fromRawArray(s1 + g);
+                const auto x2 = Lanes::fromRawArray(s2 + g);
+                const auto x3 = Lanes::fromRawArray(s3 + g);
+                const auto x4 = Lanes::fromRawArray(s4 + g);
+
+                const auto a = dx + feedback * (fb - dx * Lanes::expand(0.5f));
+                const auto b = b1 * x0 + a1 * x1 + b0 * a;
+                const auto c = b1 * x1 + a1 * x2 + b0 * b;
+                const auto d = b1 * x2 + a1 * x3 + b0 * c;
+                const auto e = b1 * x3 + a1 * x4 + b0 * d;
+
+                a.copyToRawArray(s0 + g);
+                b.copyToRawArray(s1 + g);
+                c.copyToRawArray(s2 + g);
+                d.copyToRawArray(s3 + g);
+                e.copyToRawArray(s4 + g);
+
+                e.copyToRawArray(laneFrame + g);
+                (amp * Lanes::fromRawArray(accentGain + g) * 0.5f).copyToRawArray(laneOutputGain + g);
+            }
+
+            // Overdrive, then the lane mix
+            FastTanh::shapeTanh(laneFrame, lanes, drive, driveGain);
+
+            auto mix = zero;
+            for (int g = 0; g < lanes; g += laneWidth)
+                mix = mix + Lanes::fromRawArray(laneFrame + g) * Lanes::fromRawArray(laneOutputGain + g);
+
+            output[i] = mix.sum() * laneGain;
+        }
+    }
+
+    // Settle released lanes exactly at zero so they stop counting as active
+    for (int l = 0; l < lanes; ++l)
+        if (ampSlope[l] < 0.0f && ampLevel[l] <= 0.0f)
+            ampSlope[l] = 0.0f;
+}
+
+// TB303LayeredVoice Implementation
+TB303LayeredVoice::TB303LayeredVoice()
+{
+}
+
+bool TB303LayeredVoice::canPlaySound(juce::SynthesiserSound* sound)
+{
+    return enabled && dynamic_cast<TB303Sound*>(sound) != nullptr;
+}
+
+void TB303LayeredVoice::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+    engine.prepare(sampleRate, samplesPerBlock);
+    scratch.prepare(1, samplesPerBlock);
+}
+
+void TB303LayeredVoice::updateParameters(float cutoff, float resonance, float decay,
+                                         float accent, float overdrive, int waveform)
+{
+    knobValues[ParameterLocks::cutoff] = cutoff;
+    knobValues[ParameterLocks::resonance] = resonance;
+    knobValues[ParameterLocks::decay] = decay;
+    knobValues[ParameterLocks::accent] = accent;
+    knobValues[ParameterLocks::overdrive] = overdrive;
+    knobWaveform = waveform;
+
+    applySoundParameters();
+}
+
+void TB303LayeredVoice::applySoundParameters() noexcept
+{
+    engine.setParameters(activeLocks.apply(ParameterLocks::cutoff, knobValues[ParameterLocks::cutoff]),
+                         activeLocks.apply(ParameterLocks::resonance, knobValues[ParameterLocks::resonance]),
+                         activeLocks.apply(ParameterLocks::decay, knobValues[ParameterLocks::decay]),
+                         activeLocks.apply(ParameterLocks::accent, knobValues[ParameterLocks::accent]),
+                         activeLocks.apply(ParameterLocks::overdrive, knobValues[ParameterLocks::overdrive]),
+                         knobWaveform == 1 ? TB303LaneEngine::Shape::square : TB303LaneEngine::Shape::sawtooth);
+}
+
+void TB303LayeredVoice::beginBlock(const ParameterLockQueue& parameterLocks) noexcept
+{
+    lockCursor.begin(parameterLocks);
+
+    // Notes on the first sample start before any rendering, so their locks go in now
+    if (lockCursor.advanceTo(0, activeLocks))
+        applySoundParameters();
+}
+
+void TB303LayeredVoice::setLayout(int numVoices, Spread spread)
+{
+    engine.setNumLanes(numVoices);
+    currentSpread = spread;
+}
+
+float TB303LayeredVoice::laneRatio(int lane) const noexcept
+{
+    const int numLanes = engine.getNumLanes();
+
+    if (currentSpread == Spread::octaves)
+    {
+        // 0, -1, +1, -2 octaves, with repeats nudged apart by 5 cents
+        static constexpr int octaveOffsets[] = { 0, -1, 1, -2 };
+        const float cents = 5.0f * static_cast<float>(lane / 4);
+        return std::pow(2.0f, static_cast<float>(octaveOffsets[lane % 4]) + cents / 1200.0f);
+    }
+
+    if (numLanes == 1)
+        return 1.0f;
+
+    // Symmetric detune across the unison stack
+    const float position = static_cast<float>(lane) / static_cast<float>(numLanes - 1) - 0.5f;
+    return std::pow(2.0f, position * unisonSpreadCents / 1200.0f);
+}
+
+void TB303LayeredVoice::startNote(int midiNoteNumber, float velocity,
+                                  juce::SynthesiserSound*, int)
+{
+    const float frequency = static_cast<float>(juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber));
+    const bool accented = velocity > 0.8f;
+
+    for (int lane = 0; lane < engine.getNumLanes(); ++lane)
+        engine.noteOn(lane, frequency * laneRatio(lane), accented);
+}
+
+void TB303LayeredVoice::stopNote(float, bool allowTailOff)
+{
+    if (!allowTailOff)
+    {
+        engine.reset();
+        clearCurrentNote();
+        return;
+    }
+
+    for (int lane = 0; lane < engine.getNumLanes(); ++lane)
+        engine.noteOff(lane);
+}
+
+void TB303LayeredVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer,
+                                        int startSample, int numSamples)
+{
+    const int endSample = startSample + numSamples;
+
+    // As in TB303Voice: split at every lock, taking locks while silent too
+    for (;;)
+    {
+        if (lockCursor.advanceTo(startSample, activeLocks))
+            applySoundParameters();
+
+        if (startSample >= endSample)
+            break;
+
+        const int segmentEnd = juce::jmin(endSample, lockCursor.getNextPosition());
+        renderSegment(outputBuffer, startSample, segmentEnd - startSample);
+        startSample = segmentEnd;
+    }
+}
+
+void TB303LayeredVoice::renderSegment(juce::AudioBuffer<float>& outputBuffer,
+                                      int startSample, int numSamples)
+{
+    if (!isVoiceActive())
+        return;
+
+    float* mix = scratch.getBuffer(0);
+    const int maxChunk = scratch.getMaxSamples();
+
+    while (numSamples > 0 && maxChunk > 0)
+    {
+        const int samplesThisChunk = std::min(numSamples, maxChunk);
+        engine.render(mix, samplesThisChunk);
+
+        for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+            outputBuffer.addFrom(channel, startSample, mix, samplesThisChunk);
+
+        startSample += samplesThisChunk;
+        numSamples -= samplesThisChunk;
+    }
+
+    if (!engine.isAnyLaneActive())
+        clearCurrentNote();
+}
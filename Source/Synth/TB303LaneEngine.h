@@ -0,0 +1,150 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../DSP/ScratchArena.h"
+#include "WavetableOscillator.h"
+#include "ParameterLocks.h"
+
+// Multi-lane 303 voice engine. All per-voice state lives in struct-of-arrays
+// form, one float per lane, so the envelope and ladder filter updates run on
+// dsp::SIMDRegister groups of lanes (4 on SSE/NEON, 8 on AVX) and the tanh
+// stages run through the FastTanh block kernels. Only the wavetable read is a
+// per-lane gather.
+class TB303LaneEngine
+{
+public:
+    static constexpr int laneWidth = static_cast<int>(juce::dsp::SIMDRegister<float>::SIMDNumElements);
+    static constexpr int maxLanes = 16;
+
+    using Shape = WavetableOscillator::Shape;
+
+    TB303LaneEngine();
+
+    void prepare(double sampleRate, int samplesPerBlock);
+    void reset();
+
+    void setNumLanes(int newNumLanes) noexcept;
+    int getNumLanes() const noexcept { return numLanes; }
+
+    void setParameters(float cutoff, float resonance, float decay,
+                       float accent, float overdrive, Shape shape) noexcept;
+
+    void noteOn(int lane, float frequency, bool accented) noexcept;
+    void noteOff(int lane) noexcept;
+
+    bool isAnyLaneActive() const noexcept;
+
+    // Renders the summed lanes into output (overwriting it). numSamples must
+    // not exceed the samplesPerBlock given to prepare().
+    void render(float* output, int numSamples) noexcept;
+
+private:
+    juce::SharedResourcePointer<BandLimitedWavetable> wavetable;
+
+    double sampleRate { 44100.0 };
+    int numLanes { 1 };
+    int numActiveGroupLanes { laneWidth };  // numLanes rounded up to a whole SIMD group
+
+    // Shared parameters
+    float baseCutoff { 1000.0f };
+    float scaledResonance { 0.1f };
+    float accentAmount { 0.5f };
+    float drive { 1.0f };
+    float driveGain { 1.0f };
+    float oscillatorGain { 1.0f };
+    float laneGain { 1.0f };
+    float cutoffScaler { 0.0f };
+    Shape shape { Shape::sawtooth };
+
+    // Linear envelope segments, matching the juce::ADSR settings of TB303Voice
+    float attackIncrement { 0.0f };
+    float ampReleaseSamples { 1.0f };
+    float filterDecayDecrement { 0.0f };
+    float filterReleaseSamples { 1.0f };
+
+    // Ladder input stage, as in AcidLadderFilter with the default drive
+    float ladderDrive { 1.2f }, ladderGain { 1.0f }, ladderDrive2 { 1.0f }, ladderGain2 { 1.0f };
+
+    // Per-lane state
+    alignas(32) float phase[maxLanes] {};
+    alignas(32) float phaseIncrement[maxLanes] {};
+    alignas(32) float tableBlend[maxLanes] {};
+    const float* lowerTable[maxLanes] {};
+    const float* upperTable[maxLanes] {};
+
+    alignas(32) float ampLevel[maxLanes] {};
+    alignas(32) float ampSlope[maxLanes] {};
+    alignas(32) float filterLevel[maxLanes] {};
+    alignas(32) float filterSlope[maxLanes] {};
+    alignas(32) float accentGain[maxLanes] {};
+
+    alignas(32) float pole[maxLanes] {};
+    alignas(32) float poleStep[maxLanes] {};
+    alignas(32) float s0[maxLanes] {}, s1[maxLanes] {}, s2[maxLanes] {}, s3[maxLanes] {}, s4[maxLanes] {};
+
+    // Per-sample working registers
+    alignas(32) float laneFrame[maxLanes] {};
+    alignas(32) float ladderInput[maxLanes] {};
+    alignas(32) float ladderFeedback[maxLanes] {};
+    alignas(32) float laneOutputGain[maxLanes] {};
+
+    static constexpr int controlInterval = 8;
+    static constexpr float squareWaveBoost = 1.4f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TB303LaneEngine)
+};
+
+// SynthesiserVoice that plays each note on every lane, either as a detuned
+// unison stack or as octave layers. The lanes have no HarmonicProcessor, so
+// the harmonics XY pad does not apply here; the editor greys it out.
+class TB303LayeredVoice : public juce::SynthesiserVoice
+{
+public:
+    enum class Spread { unison = 0, octaves };
+
+    TB303LayeredVoice();
+
+    bool canPlaySound (juce::SynthesiserSound*) override;
+
+    void startNote (int midiNoteNumber, float velocity,
+                    juce::SynthesiserSound*, int currentPitchWheelPosition) override;
+
+    void stopNote (float velocity, bool allowTailOff) override;
+
+    void pitchWheelMoved (int) override {}
+    void controllerMoved (int, int) override {}
+
+    void renderNextBlock (juce::AudioBuffer<float>& outputBuffer,
+                          int startSample, int numSamples) override;
+
+    void prepareToPlay (double sampleRate, int samplesPerBlock);
+
+    void updateParameters (float cutoff, float resonance, float decay,
+                           float accent, float overdrive, int waveform);
+
+    void setLayout (int numVoices, Spread spread);
+    void setEnabled (bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+
+    // Hands the voice this block's step locks; call before rendering the block
+    void beginBlock (const ParameterLockQueue& parameterLocks) noexcept;
+
+private:
+    TB303LaneEngine engine;
+    ScratchArena scratch;
+
+    // Knob values, then the step locks that currently override them
+    float knobValues[ParameterLocks::numTargets] { 1000.0f, 0.5f, 0.3f, 0.5f, 0.3f };
+    int knobWaveform { 0 };
+    ParameterLocks activeLocks;
+    ParameterLockCursor lockCursor;
+
+    void applySoundParameters() noexcept;
+    void renderSegment (juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+
+    bool enabled { false };
+    Spread currentSpread { Spread::unison };
+
+    static constexpr float unisonSpreadCents = 20.0f;
+
+    float laneRatio (int lane) const noexcept;
+};
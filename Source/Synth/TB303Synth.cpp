@@ -11,6 +11,9 @@ TB303Synth::TB303Synth()
         synth.addVoice(voice);
         voices.push_back(voice);
     }
+
+    layeredVoice = new TB303LayeredVoice();
+    synth.addVoice(layeredVoice);
 }
 
 TB303Synth::~TB303Synth()
@@ -25,32 +28,84 @@ void TB303Synth::prepareToPlay(double sampleRate, int samplesPerBlock)
     {
         voice->prepareToPlay(sampleRate, samplesPerBlock);
     }
+
+    layeredVoice->prepareToPlay(sampleRate, samplesPerBlock);
 }
 
 void TB303Synth::releaseResources()
 {
 }
 
-void TB303Synth::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void TB303Synth::beginBlock(const ParameterLockQueue& parameterLocks) noexcept
 {
-    synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+    for (auto* voice : voices)
+        voice->beginBlock(parameterLocks);
+
+    layeredVoice->beginBlock(parameterLocks);
 }
 
-void TB303Synth::updateParameters(juce::AudioProcessorValueTreeState& apvts)
+bool TB303Synth::isActive() const noexcept
 {
-    float cutoff = apvts.getRawParameterValue("cutoff")->load();
-    float resonance = apvts.getRawParameterValue("resonance")->load();
-    float decay = apvts.getRawParameterValue("decay")->load();
-    float accent = apvts.getRawParameterValue("accent")->load();
-    float overdrive = apvts.getRawParameterValue("overdrive")->load();
-    int waveform = apvts.getRawParameterValue("waveform")->load();
+    for (auto* voice : voices)
+        if (voice->isVoiceActive())
+            return true;
 
-    float harmonicAmount = apvts.getRawParameterValue("harmonicAmount")->load();
-    float subharmonicDepth = apvts.getRawParameterValue("subharmonicDepth")->load();
+    return layeredVoice->isVoiceActive();
+}
 
-    for (auto* voice : voices)
+void TB303Synth::attachParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    // Order must match ParameterIndex
+    parameters.attach(apvts, { "cutoff", "resonance", "decay", "accent", "overdrive", "waveform",
+                               "harmonicAmount", "subharmonicDepth", "harmonicShaping",
+                               "voiceCount", "voiceSpread" });
+}
+
+void TB303Synth::updateParameters()
+{
+    parameters.refresh();
+
+    if (parameters.consumeChange({ cutoffParam, resonanceParam, decayParam,
+                                   accentParam, overdriveParam, waveformParam }, voiceVersion))
     {
-        voice->updateParameters(cutoff, resonance, decay, accent, overdrive, waveform);
-        voice->updateHarmonicParameters(harmonicAmount, subharmonicDepth);
+        float cutoff = parameters.get(cutoffParam);
+        float resonance = parameters.get(resonanceParam);
+        float decay = parameters.get(decayParam);
+        float accent = parameters.get(accentParam);
+        float overdrive = parameters.get(overdriveParam);
+        int waveform = parameters.getInt(waveformParam);
+
+        for (auto* voice : voices)
+            voice->updateParameters(cutoff, resonance, decay, accent, overdrive, waveform);
+
+        layeredVoice->updateParameters(cutoff, resonance, decay, accent, overdrive, waveform);
     }
-}
\ No newline at end of file
+
+    if (parameters.consumeChange({ harmonicAmountParam, subharmonicDepthParam }, harmonicVersion))
+    {
+        for (auto* voice : voices)
+            voice->updateHarmonicParameters(parameters.get(harmonicAmountParam),
+                                            parameters.get(subharmonicDepthParam));
+    }
+
+    if (parameters.consumeChange({ harmonicShapingParam }, shapingVersion))
+    {
+        auto shapingMode = static_cast<HarmonicProcessor::ShapingMode>(parameters.getInt(harmonicShapingParam));
+
+        for (auto* voice : voices)
+            voice->setHarmonicShapingMode(shapingMode);
+    }
+
+    if (parameters.consumeChange({ voiceCountParam, voiceSpreadParam }, layoutVersion))
+    {
+        int voiceCount = parameters.getInt(voiceCountParam);
+        bool layered = voiceCount > 1;
+
+        for (auto* voice : voices)
+            voice->setEnabled(!layered);
+
+        auto spread = static_cast<TB303LayeredVoice::Spread>(parameters.getInt(voiceSpreadParam));
+        layeredVoice->setLayout(voiceCount, spread);
+        layeredVoice->setEnabled(layered);
+    }
+}
@@ -2,6 +2,10 @@
 
 #include <JuceHeader.h>
 #include "TB303Voice.h"
+#include "TB303LaneEngine.h"
+#include "ParameterLocks.h"
+#include "../Utility/ParameterSnapshot.h"
+#include "../Utility/MergedMidiEvents.h"
 
 class TB303Sound : public juce::SynthesiserSound
 {
@@ -21,13 +25,93 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock);
     void releaseResources();
 
-    void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    // Renders the block, playing the host and sequencer events in timestamp
+    // order straight from their buffers. onNote(message, samplePosition) is
+    // called for each note-on and note-off as it is played. Step locks take
+    // effect at their own sample offsets.
+    template <typename NoteCallback>
+    void processBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& hostMidi,
+                      const juce::MidiBuffer& sequencerMidi, const ParameterLockQueue& parameterLocks,
+                      NoteCallback&& onNote);
 
-    void updateParameters(juce::AudioProcessorValueTreeState& apvts);
+    // True while any voice is sounding, including release tails
+    bool isActive() const noexcept;
+
+    // Resolves the parameter handles once; updateParameters() then only
+    // pushes the groups of values that changed since the previous block
+    void attachParameters(juce::AudioProcessorValueTreeState& apvts);
+    void updateParameters();
 
 private:
+    enum ParameterIndex
+    {
+        cutoffParam, resonanceParam, decayParam, accentParam, overdriveParam, waveformParam,
+        harmonicAmountParam, subharmonicDepthParam, harmonicShapingParam,
+        voiceCountParam, voiceSpreadParam
+    };
+
     static constexpr int maxVoices = 1;
 
-    juce::Synthesiser synth;
+    // Gives TB303Synth the render and event steps of juce::Synthesiser, so
+    // it can drive them from a merged event stream instead of one MidiBuffer
+    class EventSynthesiser : public juce::Synthesiser
+    {
+    public:
+        using juce::Synthesiser::handleMidiEvent;
+        using juce::Synthesiser::renderVoices;
+        const juce::CriticalSection& getLock() const noexcept { return lock; }
+    };
+
+    EventSynthesiser synth;
     std::vector<TB303Voice*> voices;
-};
\ No newline at end of file
+
+    // Plays each note on several SIMD lanes when more than one layer is selected
+    TB303LayeredVoice* layeredVoice { nullptr };
+
+    ParameterSnapshot parameters;
+    uint32_t voiceVersion { 0 };
+    uint32_t harmonicVersion { 0 };
+    uint32_t shapingVersion { 0 };
+    uint32_t layoutVersion { 0 };
+
+    void beginBlock(const ParameterLockQueue& parameterLocks) noexcept;
+};
+
+template <typename NoteCallback>
+void TB303Synth::processBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& hostMidi,
+                              const juce::MidiBuffer& sequencerMidi, const ParameterLockQueue& parameterLocks,
+                              NoteCallback&& onNote)
+{
+    // The same loop as juce::Synthesiser::renderNextBlock with a 1-sample
+    // subdivision: render up to each event, then play it
+    const juce::ScopedLock sl(synth.getLock());
+
+    beginBlock(parameterLocks);
+
+    const int numSamples = buffer.getNumSamples();
+    int position = 0;
+
+    MergedMidiEvents events(hostMidi, sequencerMidi);
+
+    for (juce::MidiMessageMetadata event; events.next(event);)
+    {
+        // Events past the end of the block play on its last sample
+        const int eventPosition = juce::jlimit(position, numSamples, event.samplePosition);
+
+        if (eventPosition > position)
+        {
+            synth.renderVoices(buffer, position, eventPosition - position);
+            position = eventPosition;
+        }
+
+        const auto message = event.getMessage();
+
+        if (message.isNoteOnOrOff())
+            onNote(message, eventPosition);
+
+        synth.handleMidiEvent(message);
+    }
+
+    if (position < numSamples)
+        synth.renderVoices(buffer, position, numSamples - position);
+}
\ No newline at end of file
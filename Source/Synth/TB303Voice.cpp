@@ -1,4 +1,5 @@
 #include "TB303Voice.h"
+#include "../DSP/FastTanh.h"
 
 // HarmonicProcessor Implementation
 HarmonicProcessor::HarmonicProcessor()
@@ -10,29 +11,60 @@ HarmonicProcessor::HarmonicProcessor()
 void HarmonicProcessor::prepare(double sr, int samplesPerBlock)
 {
     sampleRate = sr;
+    lfo.prepare(sampleRate);
+    lfo.setFrequency(lfoRate);
+    subOscillator.prepare(sampleRate);
+    subOscillator2.prepare(sampleRate);
     oversampler->initProcessing(samplesPerBlock);
+    scratch.prepare(numScratchSlots, samplesPerBlock);
     reset();
 }
 
 void HarmonicProcessor::reset()
 {
-    subPhase = 0.0f;
-    subPhase2 = 0.0f;
+    subOscillator.reset();
+    subOscillator2.reset();
     lastSample = 0.0f;
     zeroCrossingCounter = 0;
     oversampler->reset();
+    antiderivativeShaper.reset();
+    std::fill(std::begin(dryHistory), std::end(dryHistory), 0.0f);
+    std::fill(std::begin(unshapedHistory), std::end(unshapedHistory), 0.0f);
+}
+
+void HarmonicProcessor::setShapingMode(ShapingMode newMode)
+{
+    if (shapingMode == newMode)
+        return;
+
+    shapingMode = newMode;
+
+    if (shapingMode != ShapingMode::oversampled)
+        antiderivativeShaper.setOrder(shapingMode == ShapingMode::antiderivativeFirstOrder
+                                          ? AntiderivativeShaper::Order::first
+                                          : AntiderivativeShaper::Order::second);
+
+    oversampler->reset();
+    antiderivativeShaper.reset();
+    std::fill(std::begin(dryHistory), std::end(dryHistory), 0.0f);
+    std::fill(std::begin(unshapedHistory), std::end(unshapedHistory), 0.0f);
 }
 
 void HarmonicProcessor::updateParameters(float rate, float depth)
 {
-    lfoRate = rate;
+    if (rate != lfoRate)
+    {
+        lfoRate = rate;
+        lfo.setFrequency(lfoRate);
+    }
+
     lfoDepth = depth;
 }
 
 float HarmonicProcessor::asymmetricTanh(float x, float drive, float asymmetry)
 {
     float dc = asymmetry * std::abs(x) * 0.5f;
-    float shaped = std::tanh((x + dc) * drive);
+    float shaped = FastTanh::tanh((x + dc) * drive);
     return shaped - dc * 0.5f;
 }
 
@@ -45,195 +77,241 @@ float HarmonicProcessor::chebyshevMix(float x, float amount)
     return x + (T2 * amount * 0.2f) + (T3 * amount * 0.15f) + (T4 * amount * 0.1f);  // Much stronger harmonics
 }
 
-float HarmonicProcessor::process(float input, float frequency)
+void HarmonicProcessor::applyOversampledShaping(float* samples, const float* harmonicAmounts, int numSamples)
 {
-    float output = input;
-    
-    // Update LFO phases
-    lfoPhase += (lfoRate * 2.0f * juce::MathConstants<float>::pi) / sampleRate;
-    if (lfoPhase > juce::MathConstants<float>::twoPi)
-        lfoPhase -= juce::MathConstants<float>::twoPi;
-    
-    // Second LFO with 90-degree phase offset for complex modulation
-    lfoPhase2 = lfoPhase + juce::MathConstants<float>::halfPi;
-    if (lfoPhase2 > juce::MathConstants<float>::twoPi)
-        lfoPhase2 -= juce::MathConstants<float>::twoPi;
-    
-    // Calculate modulated parameters
-    float lfoValue1 = std::sin(lfoPhase) * lfoDepth;
-    float lfoValue2 = std::sin(lfoPhase2) * lfoDepth;
-    
-    // Modulate harmonic amount (0 to baseHarmonicAmount + modulation)
-    float modulatedHarmonicAmount = baseHarmonicAmount * (1.0f + lfoValue1);
-    modulatedHarmonicAmount = juce::jlimit(0.0f, 1.0f, modulatedHarmonicAmount);
-    
-    // Modulate subharmonic depth with inverted LFO for interesting movement
-    float modulatedSubharmonicDepth = baseSubharmonicDepth * (1.0f + lfoValue2 * 0.7f);
-    modulatedSubharmonicDepth = juce::jlimit(0.0f, 1.0f, modulatedSubharmonicDepth);
-
-    // A. Generate subharmonics (modulated by LFO)
-    if (modulatedSubharmonicDepth > 0.01f)
+    // One oversampling round trip per block
+    dsp::AudioBlock<float> block(&samples, 1, static_cast<size_t>(numSamples));
+    auto oversampledBlock = oversampler->processSamplesUp(block);
+
+    float* oversampledData = oversampledBlock.getChannelPointer(0);
+    const int factor = static_cast<int>(oversampler->getOversamplingFactor());
+
+    for (int i = 0; i < numSamples; ++i)
     {
-        // Sub-octave (f/2)
-        subPhase += (frequency * 0.5f * 2.0f * juce::MathConstants<float>::pi) / sampleRate;
-        if (subPhase > juce::MathConstants<float>::twoPi)
-            subPhase -= juce::MathConstants<float>::twoPi;
-        float sub1 = std::sin(subPhase) * modulatedSubharmonicDepth * 0.7f;
-
-        // Sub-sub-octave (f/4)
-        subPhase2 += (frequency * 0.25f * 2.0f * juce::MathConstants<float>::pi) / sampleRate;
-        if (subPhase2 > juce::MathConstants<float>::twoPi)
-            subPhase2 -= juce::MathConstants<float>::twoPi;
-        float sub2 = std::sin(subPhase2) * modulatedSubharmonicDepth * 0.4f;
-
-        output += sub1 + sub2;
+        // Asymmetric tanh for even/odd harmonics (using modulated amount)
+        const float amount = harmonicAmounts[i];
+        const float drive = 1.0f + amount * 8.0f;
+        const float asymmetry = amount * 0.5f;
+
+        float* frame = oversampledData + i * factor;
+        for (int j = 0; j < factor; ++j)
+        {
+            float shaped = asymmetricTanh(frame[j], drive, asymmetry);
+
+            // Add Chebyshev harmonics
+            frame[j] = chebyshevMix(shaped, amount);
+        }
     }
 
-    // B. Apply waveshaping for overtones (modulated by LFO)
-    if (modulatedHarmonicAmount > 0.01f)
+    oversampler->processSamplesDown(block);
+}
+
+void HarmonicProcessor::applyAntiderivativeShaping(float* samples, const float* harmonicAmounts, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
     {
-        // Create a single-sample audio block for oversampling
-        float* data = &output;
-        dsp::AudioBlock<float> block(&data, 1, 1);
-        auto oversampledBlock = oversampler->processSamplesUp(block);
+        const float amount = harmonicAmounts[i];
+        samples[i] = antiderivativeShaper.processSample(samples[i], 1.0f + amount * 8.0f, amount * 0.5f, amount);
+    }
+}
 
-        float* oversampledData = oversampledBlock.getChannelPointer(0);
-        for (size_t i = 0; i < oversampledBlock.getNumSamples(); ++i)
+void HarmonicProcessor::delayBy(float* data, float* history, int latency, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float current = data[i];
+        data[i] = history[latency - 1];
+        history[1] = history[0];
+        history[0] = current;
+    }
+}
+
+void HarmonicProcessor::processBlock(float* samples, const float* frequency, int numSamples)
+{
+    jassert(numSamples <= scratch.getMaxSamples());
+
+    float* dry = scratch.getBuffer(drySlot);
+    float* unshaped = scratch.getBuffer(unshapedSlot);
+    float* harmonicAmounts = scratch.getBuffer(amountSlot);
+
+    bool anyShaping = false;
+
+    // Pass 1: LFOs and subharmonics at the base rate
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float input = samples[i];
+        float output = input;
+
+        // Calculate modulated parameters; the second LFO runs 90 degrees ahead
+        float lfoValue1 = lfo.sin() * lfoDepth;
+        float lfoValue2 = lfo.cos() * lfoDepth;
+        lfo.advance();
+
+        // Modulate harmonic amount (0 to baseHarmonicAmount + modulation)
+        float modulatedHarmonicAmount = baseHarmonicAmount * (1.0f + lfoValue1);
+        modulatedHarmonicAmount = juce::jlimit(0.0f, 1.0f, modulatedHarmonicAmount);
+
+        // Modulate subharmonic depth with inverted LFO for interesting movement
+        float modulatedSubharmonicDepth = baseSubharmonicDepth * (1.0f + lfoValue2 * 0.7f);
+        modulatedSubharmonicDepth = juce::jlimit(0.0f, 1.0f, modulatedSubharmonicDepth);
+
+        // A. Generate subharmonics (modulated by LFO)
+        if (modulatedSubharmonicDepth > 0.01f)
         {
-            float sample = oversampledData[i];
+            // Only slides change the pitch mid-note
+            if (frequency[i] != subFrequency)
+            {
+                subFrequency = frequency[i];
+                subOscillator.setFrequency(subFrequency * 0.5f);
+                subOscillator2.setFrequency(subFrequency * 0.25f);
+            }
 
-            // Asymmetric tanh for even/odd harmonics (using modulated amount)
-            float drive = 1.0f + modulatedHarmonicAmount * 8.0f;
-            float asymmetry = modulatedHarmonicAmount * 0.5f;
-            float shaped = asymmetricTanh(sample, drive, asymmetry);
+            // Sub-octave (f/2)
+            subOscillator.advance();
+            float sub1 = subOscillator.sin() * modulatedSubharmonicDepth * 0.7f;
 
-            // Add Chebyshev harmonics
-            shaped = chebyshevMix(shaped, modulatedHarmonicAmount);
+            // Sub-sub-octave (f/4)
+            subOscillator2.advance();
+            float sub2 = subOscillator2.sin() * modulatedSubharmonicDepth * 0.4f;
 
-            oversampledData[i] = shaped;
+            output += sub1 + sub2;
         }
 
-        oversampler->processSamplesDown(block);
-        output = *data;
+        dry[i] = input;
+        unshaped[i] = output;
+        samples[i] = output;
+        harmonicAmounts[i] = modulatedHarmonicAmount;
+        anyShaping = anyShaping || modulatedHarmonicAmount > 0.01f;
+    }
+
+    // B. Apply waveshaping for overtones (modulated by LFO)
+    const bool usesAntiderivative = shapingMode != ShapingMode::oversampled;
+
+    if (usesAntiderivative)
+    {
+        // ADAA delays the wet path; keep the dry paths aligned with it. All
+        // three run on every block, even while the amount is zero, so the
+        // latency stays constant and the shaper state never goes stale.
+        applyAntiderivativeShaping(samples, harmonicAmounts, numSamples);
+
+        const int latency = antiderivativeShaper.getLatencyInSamples();
+        delayBy(dry, dryHistory, latency, numSamples);
+        delayBy(unshaped, unshapedHistory, latency, numSamples);
+    }
+    else if (anyShaping)
+    {
+        applyOversampledShaping(samples, harmonicAmounts, numSamples);
+    }
 
+    if (usesAntiderivative || anyShaping)
+    {
         // Mix dry/wet (using modulated amount)
-        output = input * (1.0f - modulatedHarmonicAmount * 0.7f) + output * (0.3f + modulatedHarmonicAmount * 0.7f);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float amount = harmonicAmounts[i];
+
+            if (amount > 0.01f)
+                samples[i] = dry[i] * (1.0f - amount * 0.7f) + samples[i] * (0.3f + amount * 0.7f);
+            else
+                samples[i] = unshaped[i];
+        }
     }
 
-    lastSample = output;
-    return output;
+    if (numSamples > 0)
+        lastSample = samples[numSamples - 1];
 }
 
 // TB303Voice Implementation
 TB303Voice::TB303Voice()
 {
-    oscillator.initialise([](float x) { return std::sin(x); });
-
-    envelope.setParameters({ 0.001f, 0.0f, 1.0f, 0.3f });
-    filterEnvelope.setParameters({ 0.001f, 0.0f, 0.0f, 0.3f });
+    envelope.setParameters({ 0.001f, 0.0f, 1.0f, currentDecay });
+    filterEnvelope.setParameters({ 0.001f, currentDecay * 0.8f, 0.0f, currentDecay * 0.8f });
+    filter.setResonance(currentResonance);
 }
 
 bool TB303Voice::canPlaySound(juce::SynthesiserSound* sound)
 {
-    return true;
+    return enabled;
 }
 
 void TB303Voice::prepareToPlay(double sr, int samplesPerBlock)
 {
     sampleRate = sr;
 
-    dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-
-    oscillator.prepare(spec);
-    filter.prepare(spec);
+    oscillator.prepare(sampleRate);
+    filter.prepare(sampleRate);
+    filter.setControlInterval(filterControlInterval);
     harmonicProcessor.prepare(sampleRate, samplesPerBlock);
+    scratch.prepare(numScratchSlots, samplesPerBlock);
 
     envelope.setSampleRate(sampleRate);
     filterEnvelope.setSampleRate(sampleRate);
-
-    filter.setMode(dsp::LadderFilterMode::LPF24);
-
-    polyBLEPPhase = 0.0f;
-    lastPhase = 0.0f;
 }
 
 void TB303Voice::updateParameters(float cutoff, float resonance, float decay,
                                    float accent, float overdrive, int waveform)
 {
-    currentCutoff = cutoff;
-    currentResonance = resonance;
-    currentDecay = decay;
-    currentAccent = accent;
-    currentOverdrive = overdrive;
-    currentWaveform = static_cast<Waveform>(waveform);
+    knobValues[ParameterLocks::cutoff] = cutoff;
+    knobValues[ParameterLocks::resonance] = resonance;
+    knobValues[ParameterLocks::decay] = decay;
+    knobValues[ParameterLocks::accent] = accent;
+    knobValues[ParameterLocks::overdrive] = overdrive;
 
-    envelope.setParameters({ 0.001f, 0.0f, 1.0f, decay });
-    filterEnvelope.setParameters({ 0.001f, 0.0f, 0.0f, decay * 0.8f });
+    applySoundParameters();
 
-    updateOscillator();
-}
+    auto newWaveform = static_cast<Waveform>(waveform);
 
-void TB303Voice::updateOscillator()
-{
-    if (currentWaveform == Waveform::Sawtooth)
+    if (newWaveform != currentWaveform)
     {
-        oscillator.initialise([](float x)
-        {
-            return (2.0f * x / juce::MathConstants<float>::twoPi) - 1.0f;
-        });
+        currentWaveform = newWaveform;
+        oscillator.setShape(currentWaveform == Waveform::Square ? WavetableOscillator::Shape::square
+                                                                : WavetableOscillator::Shape::sawtooth);
     }
-    // Square wave now uses PolyBLEP, so we don't need to reinitialize here
 }
 
-void TB303Voice::updateHarmonicParameters(float lfoRate, float lfoDepth)
+void TB303Voice::applySoundParameters()
 {
-    harmonicProcessor.updateParameters(lfoRate, lfoDepth);
-}
+    currentCutoff = activeLocks.apply(ParameterLocks::cutoff, knobValues[ParameterLocks::cutoff]);
+    currentAccent = activeLocks.apply(ParameterLocks::accent, knobValues[ParameterLocks::accent]);
+    currentOverdrive = activeLocks.apply(ParameterLocks::overdrive, knobValues[ParameterLocks::overdrive]);
 
-float TB303Voice::polyBLEP(float phase, float phaseInc)
-{
-    float dt = phaseInc / juce::MathConstants<float>::twoPi;
+    const float decay = activeLocks.apply(ParameterLocks::decay, knobValues[ParameterLocks::decay]);
+    const float resonance = activeLocks.apply(ParameterLocks::resonance, knobValues[ParameterLocks::resonance]);
 
-    // Handle discontinuity at phase = 0
-    if (phase < phaseInc)
+    // Only rebuild the stages whose inputs actually moved
+    if (decay != currentDecay)
     {
-        float t = phase / phaseInc;
-        return 2.0f * t - t * t - 1.0f;
+        currentDecay = decay;
+        envelope.setParameters({ 0.001f, 0.0f, 1.0f, decay });
+        // Filter envelope decays to zero while the note is held, like the 303's MEG
+        filterEnvelope.setParameters({ 0.001f, decay * 0.8f, 0.0f, decay * 0.8f });
     }
-    // Handle discontinuity at phase = π
-    else if (phase > juce::MathConstants<float>::pi &&
-             lastPhase <= juce::MathConstants<float>::pi)
+
+    if (resonance != currentResonance)
     {
-        float t = (phase - juce::MathConstants<float>::pi) / phaseInc;
-        return -(2.0f * t - t * t - 1.0f);
+        currentResonance = resonance;
+        filter.setResonance(resonance);
     }
-
-    return 0.0f;
 }
 
-float TB303Voice::generatePolyBLEPSquare(float frequency)
+void TB303Voice::beginBlock(const ParameterLockQueue& parameterLocks) noexcept
 {
-    float phaseInc = (frequency * juce::MathConstants<float>::twoPi) / sampleRate;
-
-    polyBLEPPhase += phaseInc;
-    if (polyBLEPPhase >= juce::MathConstants<float>::twoPi)
-        polyBLEPPhase -= juce::MathConstants<float>::twoPi;
-
-    // Generate basic square wave
-    float value = polyBLEPPhase < juce::MathConstants<float>::pi ? 1.0f : -1.0f;
+    lockCursor.begin(parameterLocks);
 
-    // Add PolyBLEP correction at discontinuities
-    value += polyBLEP(polyBLEPPhase, phaseInc);
-
-    lastPhase = polyBLEPPhase;
+    // Notes on the first sample start before any rendering, so their locks go in now
+    if (lockCursor.advanceTo(0, activeLocks))
+        applySoundParameters();
+}
 
-    // Apply amplitude boost for square wave
-    return value * squareWaveBoost;
+void TB303Voice::updateHarmonicParameters(float lfoRate, float lfoDepth)
+{
+    harmonicProcessor.updateParameters(lfoRate, lfoDepth);
 }
 
+void TB303Voice::setHarmonicShapingMode(HarmonicProcessor::ShapingMode mode)
+{
+    harmonicProcessor.setShapingMode(mode);
+}
 
 void TB303Voice::startNote(int midiNoteNumber, float velocity,
                             juce::SynthesiserSound*, int currentPitchWheelPosition)
@@ -244,12 +322,7 @@ void TB303Voice::startNote(int midiNoteNumber, float velocity,
     {
         currentFrequency = targetFrequency;
         oscillator.setFrequency(currentFrequency);
-        // Reset PolyBLEP phase for square wave
-        if (currentWaveform == Waveform::Square)
-        {
-            polyBLEPPhase = 0.0f;
-            lastPhase = 0.0f;
-        }
+        oscillator.resetPhase();
     }
     else
     {
@@ -284,15 +357,54 @@ void TB303Voice::controllerMoved(int controllerNumber, int newControllerValue)
 
 void TB303Voice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer,
                                   int startSample, int numSamples)
+{
+    const int endSample = startSample + numSamples;
+
+    // Rendering stops at every lock, so each takes effect on its own sample.
+    // Locks are taken while the voice is silent too, and a lock at the end of
+    // this range is in place before a note starting there.
+    for (;;)
+    {
+        if (lockCursor.advanceTo(startSample, activeLocks))
+            applySoundParameters();
+
+        if (startSample >= endSample)
+            break;
+
+        const int segmentEnd = juce::jmin(endSample, lockCursor.getNextPosition());
+        renderSegment(outputBuffer, startSample, segmentEnd - startSample);
+        startSample = segmentEnd;
+    }
+}
+
+void TB303Voice::renderSegment(juce::AudioBuffer<float>& outputBuffer,
+                               int startSample, int numSamples)
 {
     if (!isVoiceActive())
         return;
 
-    juce::AudioBuffer<float> synthBuffer(1, numSamples);
-    synthBuffer.clear();
+    const int maxChunk = scratch.getMaxSamples();
+    jassert(maxChunk > 0);  // prepareToPlay must run before rendering
+
+    // Hosts may deliver more samples than announced; render in arena-sized chunks
+    while (numSamples > 0 && maxChunk > 0 && isVoiceActive())
+    {
+        const int samplesThisChunk = std::min(numSamples, maxChunk);
+        renderChunk(outputBuffer, startSample, samplesThisChunk);
+        startSample += samplesThisChunk;
+        numSamples -= samplesThisChunk;
+    }
+}
 
-    juce::AudioBuffer<float> envBuffer(1, numSamples);
-    envBuffer.clear();
+void TB303Voice::renderChunk(juce::AudioBuffer<float>& outputBuffer,
+                             int startSample, int numSamples)
+{
+    float* synthData = scratch.getBuffer(synthSlot);
+    float* envData = scratch.getBuffer(envelopeSlot);
+    float* freqData = scratch.getBuffer(frequencySlot);
+    float* cutoffData = scratch.getBuffer(cutoffSlot);
+
+    const float oscillatorGain = currentWaveform == Waveform::Square ? squareWaveBoost : 1.0f;
 
     for (int sample = 0; sample < numSamples; ++sample)
     {
@@ -307,57 +419,41 @@ void TB303Voice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer,
             oscillator.setFrequency(currentFrequency);
         }
 
-        // Generate oscillator sample (with PolyBLEP for square)
-        float oscSample;
-        if (currentWaveform == Waveform::Square)
-        {
-            oscSample = generatePolyBLEPSquare(currentFrequency);
-        }
-        else
-        {
-            oscSample = oscillator.processSample(0.0f);
-        }
+        // Band-limited wavetable oscillator, crossfading octave tables as the pitch moves
+        synthData[sample] = oscillator.processSample() * oscillatorGain;
+        freqData[sample] = currentFrequency;
+    }
 
-        // Apply harmonic processing to add overtones/undertones
-        oscSample = harmonicProcessor.process(oscSample, currentFrequency);
+    // Apply harmonic processing to add overtones/undertones
+    harmonicProcessor.processBlock(synthData, freqData, numSamples);
 
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
         float envValue = envelope.getNextSample();
         float filterEnvValue = filterEnvelope.getNextSample();
 
         float accentMultiplier = isAccented ? (1.0f + currentAccent) : 1.0f;
         float cutoffFreq = currentCutoff * (1.0f + filterEnvValue * 4.0f) * accentMultiplier;
-        cutoffFreq = juce::jlimit(20.0f, 20000.0f, cutoffFreq);
-
-        filter.setCutoffFrequencyHz(cutoffFreq);
-        filter.setResonance(currentResonance);
+        cutoffData[sample] = juce::jlimit(20.0f, 20000.0f, cutoffFreq);
 
-        synthBuffer.setSample(0, sample, oscSample);
-        envBuffer.setSample(0, sample, envValue * accentMultiplier);
+        envData[sample] = envValue * accentMultiplier;
     }
 
-    dsp::AudioBlock<float> block(synthBuffer);
-    dsp::ProcessContextReplacing<float> context(block);
-    filter.process(context);
+    // Envelope and accent sweeps reach the filter sample by sample
+    filter.process(synthData, cutoffData, numSamples);
 
     // Apply overdrive/waveshaping
     float drive = 1.0f + currentOverdrive * 9.0f;
-    for (int sample = 0; sample < numSamples; ++sample)
-    {
-        float inputSample = synthBuffer.getSample(0, sample);
-        float shapedSample = std::tanh(inputSample * drive) / std::tanh(drive);
-        synthBuffer.setSample(0, sample, shapedSample);
-    }
+    FastTanh::shapeTanh(synthData, numSamples, drive, 1.0f / std::tanh(drive));
 
     for (int sample = 0; sample < numSamples; ++sample)
     {
-        float envValue = envBuffer.getSample(0, sample);
-        float processedSample = synthBuffer.getSample(0, sample);
-        synthBuffer.setSample(0, sample, processedSample * envValue * 0.5f);
+        synthData[sample] *= envData[sample] * 0.5f;
     }
 
     for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
     {
-        outputBuffer.addFrom(channel, startSample, synthBuffer, 0, 0, numSamples);
+        outputBuffer.addFrom(channel, startSample, synthData, numSamples);
     }
 
     if (!envelope.isActive())
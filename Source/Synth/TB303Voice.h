@@ -1,16 +1,29 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../DSP/AntiderivativeShaper.h"
+#include "../DSP/QuadratureOscillator.h"
+#include "../DSP/ScratchArena.h"
+#include "AcidLadderFilter.h"
+#include "ParameterLocks.h"
+#include "WavetableOscillator.h"
 
 // Harmonic processor for adding overtones and undertones
 class HarmonicProcessor
 {
 public:
+    // How the overtone waveshaper controls aliasing
+    enum class ShapingMode { oversampled = 0, antiderivativeFirstOrder, antiderivativeSecondOrder };
+
     HarmonicProcessor();
 
     void prepare(double sampleRate, int samplesPerBlock);
-    float process(float input, float frequency);
+
+    // Processes a voice block in place; frequency holds the per-sample pitch in Hz.
+    // numSamples must not exceed the samplesPerBlock given to prepare().
+    void processBlock(float* samples, const float* frequency, int numSamples);
     void updateParameters(float lfoRate, float lfoDepth);
+    void setShapingMode(ShapingMode newMode);
     void reset();
 
 private:
@@ -20,26 +33,40 @@ private:
     float lfoRate { 2.0f };      // X-axis: LFO speed in Hz (0.1 to 20 Hz)
     float lfoDepth { 0.5f };     // Y-axis: LFO modulation depth (0-1)
     
-    // LFO state
-    float lfoPhase { 0.0f };
-    float lfoPhase2 { 0.0f };    // Second LFO with phase offset for subharmonics
+    // LFO state: sin drives the harmonic amount, cos (90 degrees ahead) the subharmonics
+    QuadratureOscillator lfo;
     
     // Base harmonic levels (modulated by LFO)
     static constexpr float baseHarmonicAmount { 0.4f };
     static constexpr float baseSubharmonicDepth { 0.3f };
 
-    // Subharmonic generation
-    float subPhase { 0.0f };
-    float subPhase2 { 0.0f };
+    // Subharmonic generation at f/2 and f/4, retuned only when the pitch moves
+    QuadratureOscillator subOscillator;
+    QuadratureOscillator subOscillator2;
+    float subFrequency { 0.0f };
     float lastSample { 0.0f };
     int zeroCrossingCounter { 0 };
 
     // Oversampling for anti-aliasing
     std::unique_ptr<dsp::Oversampling<float>> oversampler;
 
+    // Antiderivative anti-aliasing alternative to the oversampler
+    ShapingMode shapingMode { ShapingMode::oversampled };
+    AntiderivativeShaper antiderivativeShaper;
+    float dryHistory[2] {};
+    float unshapedHistory[2] {};
+
+    // Block scratch: dry input, pre-shaper signal and per-sample modulated harmonic amount
+    enum ScratchSlot { drySlot = 0, unshapedSlot, amountSlot, numScratchSlots };
+    ScratchArena scratch;
+
     // Waveshaping functions
     float asymmetricTanh(float x, float drive, float asymmetry);
     float chebyshevMix(float x, float amount);
+
+    void applyOversampledShaping(float* samples, const float* harmonicAmounts, int numSamples);
+    void applyAntiderivativeShaping(float* samples, const float* harmonicAmounts, int numSamples);
+    static void delayBy(float* data, float* history, int latency, int numSamples);
 };
 
 class TB303Voice : public juce::SynthesiserVoice
@@ -67,17 +94,30 @@ public:
                            float accent, float overdrive, int waveform);
 
     void updateHarmonicParameters(float lfoRate, float lfoDepth);
+    void setHarmonicShapingMode(HarmonicProcessor::ShapingMode mode);
+
+    // Hands the voice this block's step locks; call before rendering the block
+    void beginBlock(const ParameterLockQueue& parameterLocks) noexcept;
+
+    // A disabled voice refuses new notes, so the synth can hand them to the
+    // layered voice instead
+    void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
 
 private:
     enum class Waveform { Sawtooth, Square };
 
-    dsp::Oscillator<float> oscillator;
-    dsp::LadderFilter<float> filter;
+    WavetableOscillator oscillator;
+    AcidLadderFilter filter;
     HarmonicProcessor harmonicProcessor;
 
     juce::ADSR envelope;
     juce::ADSR filterEnvelope;
 
+    // Knob values, then the step locks that currently override them
+    float knobValues[ParameterLocks::numTargets] { 1000.0f, 0.5f, 0.3f, 0.5f, 0.3f };
+    ParameterLocks activeLocks;
+    ParameterLockCursor lockCursor;
+
     float currentCutoff { 1000.0f };
     float currentResonance { 0.5f };
     float currentDecay { 0.3f };
@@ -90,16 +130,20 @@ private:
     float slideRate { 0.01f };
     bool isSliding { false };
     bool isAccented { false };
+    bool enabled { true };
 
     double sampleRate { 44100.0 };
 
-    // PolyBLEP for anti-aliased square wave
-    float polyBLEPPhase { 0.0f };
-    float lastPhase { 0.0f };
-    float generatePolyBLEPSquare(float frequency);
-    float polyBLEP(float phase, float phaseInc);
+    // Per-voice scratch memory, sized in prepareToPlay so rendering never allocates
+    enum ScratchSlot { synthSlot = 0, envelopeSlot, frequencySlot, cutoffSlot, numScratchSlots };
+    ScratchArena scratch;
+
+    void applySoundParameters();
+    void renderSegment(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+    void renderChunk(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
 
-    void updateOscillator();
+    // Cutoff is recomputed per sample; filter coefficients follow every few samples
+    static constexpr int filterControlInterval = 8;
 
     // Amplitude compensation for square wave
     static constexpr float squareWaveBoost { 1.4f };
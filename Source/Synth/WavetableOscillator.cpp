@@ -0,0 +1,111 @@
+#include "WavetableOscillator.h"
+
+// BandLimitedWavetable Implementation
+BandLimitedWavetable::BandLimitedWavetable()
+{
+    constexpr int numShapes = static_cast<int>(Shape::numShapes);
+    tables.resize(static_cast<size_t>(numShapes * numTables * tableStride));
+
+    // Exact sine lookup: sin(2*pi*k*n/N) == sine[(k*n) mod N]
+    std::vector<double> sine(tableSize);
+    for (int n = 0; n < tableSize; ++n)
+        sine[(size_t) n] = std::sin(juce::MathConstants<double>::twoPi * n / tableSize);
+
+    std::vector<double> accumulator(tableSize);
+
+    for (int s = 0; s < numShapes; ++s)
+    {
+        std::fill(accumulator.begin(), accumulator.end(), 0.0);
+
+        // Add harmonics from the bottom up, snapshotting each octave's table on the way
+        int harmonic = 1;
+        for (int t = numTables - 1; t >= 0; --t)
+        {
+            const int harmonicsInTable = maxHarmonics >> t;
+
+            for (; harmonic <= harmonicsInTable; ++harmonic)
+            {
+                double amplitude;
+
+                if (static_cast<Shape>(s) == Shape::sawtooth)
+                    amplitude = (harmonic % 2 == 1 ? 2.0 : -2.0) / (juce::MathConstants<double>::pi * harmonic);
+                else
+                    amplitude = harmonic % 2 == 1 ? 4.0 / (juce::MathConstants<double>::pi * harmonic) : 0.0;
+
+                if (amplitude == 0.0)
+                    continue;
+
+                for (int n = 0; n < tableSize; ++n)
+                    accumulator[(size_t) n] += amplitude * sine[(size_t) ((harmonic * n) & (tableSize - 1))];
+            }
+
+            float* table = tables.data() + (s * numTables + t) * tableStride;
+            for (int n = 0; n < tableSize; ++n)
+                table[n] = static_cast<float>(accumulator[(size_t) n]);
+            table[tableSize] = table[0];
+        }
+    }
+}
+
+const float* BandLimitedWavetable::getTable(Shape shape, int tableIndex) const noexcept
+{
+    jassert(tableIndex >= 0 && tableIndex < numTables);
+    return tables.data() + (static_cast<int>(shape) * numTables + tableIndex) * tableStride;
+}
+
+// WavetableOscillator Implementation
+void WavetableOscillator::prepare(double sr)
+{
+    sampleRate = sr;
+    phase = 0.0f;
+    setFrequency(frequency);
+}
+
+void WavetableOscillator::setShape(Shape newShape) noexcept
+{
+    if (shape != newShape)
+    {
+        shape = newShape;
+        selectTables();
+    }
+}
+
+void WavetableOscillator::setFrequency(float frequencyHz) noexcept
+{
+    frequency = frequencyHz;
+    phaseIncrement = static_cast<float>(frequency / sampleRate);
+    selectTables();
+}
+
+void WavetableOscillator::selectTables() noexcept
+{
+    selectTables(*wavetable, shape, phaseIncrement, lowerTable, upperTable, tableBlend);
+}
+
+void WavetableOscillator::selectTables(const BandLimitedWavetable& tables, Shape tableShape, float increment,
+                                       const float*& lower, const float*& upper, float& blend) noexcept
+{
+    // Table i is alias-free while i >= log2(2 * maxHarmonics * normalisedFrequency).
+    // frexp gives a cheap piecewise-linear log2 whose integer part picks the
+    // table pair and whose fractional part is the crossfade position.
+    int exponent = 0;
+    const float mantissa = std::frexp(increment * 2.0f * BandLimitedWavetable::maxHarmonics, &exponent);
+
+    int index = exponent;  // floor(log2) + 1
+    float crossfade = 2.0f * mantissa - 1.0f;
+
+    if (increment <= 0.0f || index < 0)
+    {
+        index = 0;
+        crossfade = 0.0f;
+    }
+    else if (index >= BandLimitedWavetable::numTables - 1)
+    {
+        index = BandLimitedWavetable::numTables - 1;
+        crossfade = 0.0f;
+    }
+
+    lower = tables.getTable(tableShape, index);
+    upper = tables.getTable(tableShape, juce::jmin(index + 1, BandLimitedWavetable::numTables - 1));
+    blend = crossfade;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Precomputed, mip-mapped band-limited tables for the 303 waveforms.
+// One table per octave: table i holds (maxHarmonics >> i) harmonics, so it is
+// alias-free for normalised frequencies up to 0.5 / (maxHarmonics >> i).
+// Built once and shared by every oscillator through SharedResourcePointer.
+class BandLimitedWavetable
+{
+public:
+    enum class Shape { sawtooth = 0, square, numShapes };
+
+    static constexpr int tableSize = 4096;
+    static constexpr int numTables = 11;
+    static constexpr int maxHarmonics = 1 << (numTables - 1);
+
+    BandLimitedWavetable();
+
+    // Each table has tableSize + 1 samples; the last one repeats the first for interpolation
+    const float* getTable(Shape shape, int tableIndex) const noexcept;
+
+private:
+    static constexpr int tableStride = tableSize + 1;
+
+    std::vector<float> tables;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BandLimitedWavetable)
+};
+
+// Per-voice phase state reading the shared tables. The two octave tables
+// around the current pitch are crossfaded, so glides never switch tables
+// abruptly and never alias.
+class WavetableOscillator
+{
+public:
+    using Shape = BandLimitedWavetable::Shape;
+
+    WavetableOscillator() = default;
+
+    void prepare(double sampleRate);
+    void setShape(Shape newShape) noexcept;
+    void setFrequency(float frequencyHz) noexcept;
+    void resetPhase() noexcept { phase = 0.0f; }
+
+    // Picks the octave table pair and crossfade position for a normalised frequency.
+    // Shared with the multi-lane voice engine, which keeps this state per lane.
+    static void selectTables(const BandLimitedWavetable& tables, Shape tableShape, float increment,
+                             const float*& lower, const float*& upper, float& blend) noexcept;
+
+    // Linearly interpolated read of both tables at phase in [0, 1), crossfaded by blend
+    static float readTables(const float* lower, const float* upper, float blend, float readPhase) noexcept
+    {
+        const float position = readPhase * static_cast<float>(BandLimitedWavetable::tableSize);
+        const int index = static_cast<int>(position);
+        const float fraction = position - static_cast<float>(index);
+
+        const float lowerValue = lower[index] + fraction * (lower[index + 1] - lower[index]);
+        const float upperValue = upper[index] + fraction * (upper[index + 1] - upper[index]);
+
+        return lowerValue + blend * (upperValue - lowerValue);
+    }
+
+    float processSample() noexcept
+    {
+        const float value = readTables(lowerTable, upperTable, tableBlend, phase);
+
+        phase += phaseIncrement;
+        if (phase >= 1.0f)
+            phase -= 1.0f;
+
+        return value;
+    }
+
+private:
+    juce::SharedResourcePointer<BandLimitedWavetable> wavetable;
+
+    double sampleRate { 44100.0 };
+    Shape shape { Shape::sawtooth };
+    float frequency { 440.0f };
+
+    float phase { 0.0f };
+    float phaseIncrement { 0.0f };
+
+    // Richer table and the next one up, blended by tableBlend
+    const float* lowerTable { nullptr };
+    const float* upperTable { nullptr };
+    float tableBlend { 0.0f };
+
+    void selectTables() noexcept;
+};
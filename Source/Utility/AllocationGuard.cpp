@@ -0,0 +1,161 @@
+#include "AllocationGuard.h"
+
+#if SPREADSHEETS_CHECK_AUDIO_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+ #include <malloc.h>
+#endif
+
+#if defined(__GLIBC__)
+extern "C"
+{
+    void* __libc_malloc(std::size_t);
+    void* __libc_calloc(std::size_t, std::size_t);
+    void* __libc_realloc(void*, std::size_t);
+}
+#endif
+
+namespace
+{
+    thread_local int guardDepth = 0;
+    thread_local int allocationCount = 0;
+    std::atomic<int> violationCount { 0 };
+
+    inline void noteAllocation() noexcept
+    {
+        if (guardDepth > 0)
+            ++allocationCount;
+    }
+
+    // Allocates without counting. On glibc, malloc is interposed below and
+    // counts by itself, so operator new must not go through it.
+    inline void* uncountedMalloc(std::size_t size) noexcept
+    {
+       #if defined(__GLIBC__)
+        return __libc_malloc(size);
+       #else
+        return std::malloc(size);
+       #endif
+    }
+
+    // posix_memalign does not call the interposed malloc, so it is not counted twice
+    inline void* uncountedAlignedMalloc(std::size_t size, std::align_val_t alignment) noexcept
+    {
+        const auto bytes = static_cast<std::size_t>(alignment);
+
+       #if defined(_MSC_VER)
+        return _aligned_malloc(size, bytes);
+       #else
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, bytes < sizeof(void*) ? sizeof(void*) : bytes, size) == 0 ? ptr : nullptr;
+       #endif
+    }
+
+    inline void alignedFree(void* ptr) noexcept
+    {
+       #if defined(_MSC_VER)
+        _aligned_free(ptr);
+       #else
+        std::free(ptr);
+       #endif
+    }
+}
+
+ScopedNoAllocationCheck::ScopedNoAllocationCheck() noexcept
+    : allocationsAtStart(allocationCount)
+{
+    ++guardDepth;
+}
+
+ScopedNoAllocationCheck::~ScopedNoAllocationCheck()
+{
+    --guardDepth;
+
+    if (allocationCount != allocationsAtStart)
+    {
+        ++violationCount;
+        // Heap allocation detected inside an audio-thread scope
+        jassertfalse;
+    }
+}
+
+int ScopedNoAllocationCheck::getViolationCount() noexcept
+{
+    return violationCount.load();
+}
+
+// Counting replacements for the global allocation functions. The array and
+// nothrow forms forward to these by default.
+void* operator new(std::size_t size)
+{
+    noteAllocation();
+
+    if (auto* ptr = uncountedMalloc(size != 0 ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Over-aligned types (alignas above the default new alignment, such as SIMD
+// members) go through these instead
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    noteAllocation();
+
+    if (auto* ptr = uncountedAlignedMalloc(size != 0 ? size : 1, alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    alignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    alignedFree(ptr);
+}
+
+#if defined(__GLIBC__)
+// juce::HeapBlock (and therefore AudioBuffer) allocates through malloc, so on
+// glibc the C allocator is interposed as well. Elsewhere only operator new is
+// counted: macOS and Windows do not let a program replace malloc this way.
+extern "C"
+{
+    void* malloc(std::size_t size)
+    {
+        noteAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(std::size_t count, std::size_t size)
+    {
+        noteAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, std::size_t size)
+    {
+        noteAllocation();
+        return __libc_realloc(ptr, size);
+    }
+}
+#endif
+
+#endif
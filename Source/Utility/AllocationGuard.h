@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Debug/test helper that flags heap allocations on the audio thread.
+//
+// Build with SPREADSHEETS_CHECK_AUDIO_ALLOCATIONS=1 (CMake option of the same
+// name) to replace the global allocation functions with counting versions.
+// A ScopedNoAllocationCheck placed at the top of processBlock then asserts if
+// anything on the same thread allocated before the scope ends. Without the
+// flag the guard compiles to nothing.
+#ifndef SPREADSHEETS_CHECK_AUDIO_ALLOCATIONS
+ #define SPREADSHEETS_CHECK_AUDIO_ALLOCATIONS 0
+#endif
+
+class ScopedNoAllocationCheck
+{
+public:
+   #if SPREADSHEETS_CHECK_AUDIO_ALLOCATIONS
+    ScopedNoAllocationCheck() noexcept;
+    ~ScopedNoAllocationCheck();
+
+    // Total number of guarded scopes that allocated, for test harnesses
+    static int getViolationCount() noexcept;
+
+   private:
+    int allocationsAtStart;
+   #else
+    ScopedNoAllocationCheck() noexcept {}
+    static int getViolationCount() noexcept { return 0; }
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedNoAllocationCheck)
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Something the GUI shows that happened on the audio thread
+struct AudioEvent
+{
+    enum class Type : uint8_t { noteOn, noteOff, stepAdvance, transport };
+
+    Type type { Type::noteOn };
+    int value { 0 };               // note number, step index, or 1 when the transport started
+    juce::int64 sampleTime { 0 };  // samples since prepareToPlay
+};
+
+// Carries AudioEvents from the audio thread to the message thread. One
+// producer, one consumer, fixed storage: pushing never locks or allocates.
+// If the GUI falls behind or has no editor open, new events are dropped
+// until it catches up.
+class AudioEventFifo
+{
+public:
+    static constexpr int capacity = 1024;
+
+    AudioEventFifo() = default;
+
+    // Audio thread: events pushed afterwards are stamped relative to this sample
+    void beginBlock(juce::int64 blockStartSample) noexcept { blockStart = blockStartSample; }
+
+    void push(AudioEvent::Type type, int value, int sampleOffset) noexcept
+    {
+        const auto scope = fifo.write(1);
+
+        if (scope.blockSize1 > 0)
+            events[static_cast<size_t>(scope.startIndex1)] = { type, value, blockStart + sampleOffset };
+    }
+
+    // Message thread: hands every waiting event to callback, oldest first
+    template <typename Callback>
+    void drain(Callback&& callback)
+    {
+        const auto scope = fifo.read(fifo.getNumReady());
+        scope.forEach([&](int index) { callback(events[static_cast<size_t>(index)]); });
+    }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<AudioEvent, capacity> events;
+    juce::int64 blockStart { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(AudioEventFifo)
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Reads two time-ordered MidiBuffers as one stream in timestamp order. The
+// events are read where they lie, so merging copies no MIDI data and never
+// allocates. On equal timestamps the first buffer's events come first, the
+// order MidiBuffer::addEvents would have given them.
+class MergedMidiEvents
+{
+public:
+    MergedMidiEvents(const juce::MidiBuffer& firstBuffer, const juce::MidiBuffer& secondBuffer) noexcept
+        : first(firstBuffer.cbegin()), firstEnd(firstBuffer.cend()),
+          second(secondBuffer.cbegin()), secondEnd(secondBuffer.cend())
+    {
+    }
+
+    // Fills event with the next event and returns true, or returns false at the end
+    bool next(juce::MidiMessageMetadata& event) noexcept
+    {
+        const bool firstHasMore = first != firstEnd;
+        const bool secondHasMore = second != secondEnd;
+
+        if (!firstHasMore && !secondHasMore)
+            return false;
+
+        if (firstHasMore && (!secondHasMore || (*first).samplePosition <= (*second).samplePosition))
+            event = *first++;
+        else
+            event = *second++;
+
+        return true;
+    }
+
+private:
+    juce::MidiBufferIterator first, firstEnd, second, secondEnd;
+};
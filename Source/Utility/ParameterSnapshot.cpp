@@ -0,0 +1,63 @@
+#include "ParameterSnapshot.h"
+
+void ParameterSnapshot::attach(juce::AudioProcessorValueTreeState& apvts,
+                               std::initializer_list<const char*> parameterIDs)
+{
+    entries.clear();
+    entries.reserve(parameterIDs.size());
+
+    for (auto* parameterID : parameterIDs)
+    {
+        Entry entry;
+        entry.handle = apvts.getRawParameterValue(parameterID);
+        jassert(entry.handle != nullptr);  // unknown parameter ID
+
+        // Start every parameter one version ahead of a fresh consumer, so the
+        // first refresh pushes all values through
+        entry.value = entry.handle->load();
+        entry.version = 1;
+        entries.push_back(entry);
+    }
+}
+
+void ParameterSnapshot::refresh() noexcept
+{
+    for (auto& entry : entries)
+    {
+        const float newValue = entry.handle->load(std::memory_order_relaxed);
+
+        if (newValue != entry.value)
+        {
+            entry.value = newValue;
+            ++entry.version;
+        }
+    }
+}
+
+float ParameterSnapshot::get(int index) const noexcept
+{
+    jassert(index >= 0 && index < static_cast<int>(entries.size()));
+    return entries[static_cast<size_t>(index)].value;
+}
+
+uint32_t ParameterSnapshot::getVersion(int index) const noexcept
+{
+    jassert(index >= 0 && index < static_cast<int>(entries.size()));
+    return entries[static_cast<size_t>(index)].version;
+}
+
+bool ParameterSnapshot::consumeChange(std::initializer_list<int> indices,
+                                      uint32_t& lastSeenVersion) const noexcept
+{
+    // Versions only ever increase, so their sum moves whenever any one does
+    uint32_t combinedVersion = 0;
+
+    for (auto index : indices)
+        combinedVersion += getVersion(index);
+
+    if (combinedVersion == lastSeenVersion)
+        return false;
+
+    lastSeenVersion = combinedVersion;
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Per-block copy of a fixed set of APVTS parameters. The std::atomic<float>
+// handles are resolved once in attach(); refresh() loads each one and bumps
+// that parameter's version when its value moved, so consumers only have to
+// compare version numbers to know whether to recompute anything.
+class ParameterSnapshot
+{
+public:
+    ParameterSnapshot() = default;
+
+    // Resolves the handles in the given order; the index of each ID is the
+    // index used by get() and the version queries. Call from the message
+    // thread before the first processBlock.
+    void attach(juce::AudioProcessorValueTreeState& apvts,
+                std::initializer_list<const char*> parameterIDs);
+
+    void refresh() noexcept;
+
+    float get(int index) const noexcept;
+    int getInt(int index) const noexcept { return static_cast<int>(get(index)); }
+
+    uint32_t getVersion(int index) const noexcept;
+
+    // True when any of the given parameters changed since lastSeenVersion was
+    // recorded, in which case lastSeenVersion is brought up to date.
+    bool consumeChange(std::initializer_list<int> indices, uint32_t& lastSeenVersion) const noexcept;
+
+private:
+    struct Entry
+    {
+        std::atomic<float>* handle { nullptr };
+        float value { 0.0f };
+        uint32_t version { 0 };
+    };
+
+    std::vector<Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterSnapshot)
+};
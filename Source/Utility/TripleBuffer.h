@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Hands whole values from one writer thread to one reader thread without
+// locks. The writer fills its private buffer and publishes it; the reader
+// swaps in the newest published buffer when it chooses to. Each side only
+// ever touches a buffer the other cannot reach, so the reader never sees a
+// half-written value, and neither side allocates or waits.
+template <typename Value>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    // Writer side
+    Value& getWriteBuffer() noexcept { return buffers[writeIndex]; }
+
+    void publish() noexcept
+    {
+        const int previous = middle.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Reader side: takes the newest published value, if there is one;
+    // returns true when the read buffer changed
+    bool acquire() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        const int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const Value& getReadBuffer() const noexcept { return buffers[readIndex]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    Value buffers[3] {};
+    int writeIndex { 0 };
+    int readIndex { 1 };
+    std::atomic<int> middle { 2 };
+
+    JUCE_DECLARE_NON_COPYABLE(TripleBuffer)
+};
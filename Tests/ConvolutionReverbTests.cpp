@@ -0,0 +1,148 @@
+#include <JuceHeader.h>
+#include "../Source/Effects/ConvolutionReverb.h"
+
+class ConvolutionReverbTests : public juce::UnitTest
+{
+public:
+    ConvolutionReverbTests() : juce::UnitTest("ConvolutionReverb", "Effects") {}
+
+    void runTest() override
+    {
+        beginTest("The wet output is the impulse convolution, one head block late");
+        {
+            ConvolutionReverb reverb;
+            prepare(reverb, 1.0f);
+            expectLessThan(maxErrorAgainstDirectConvolution(reverb, 1.0f), 1.0e-5);
+        }
+
+        beginTest("After a reset the worker clears the tail and the output starts afresh");
+        {
+            ConvolutionReverb reverb;
+            prepare(reverb, 1.0f);
+
+            // Leave a partial tail block behind, then reset mid-stream
+            auto random = getRandom();
+            juce::AudioBuffer<float> noise(2, 777);
+
+            for (int block = 0; block < 200; ++block)
+            {
+                for (int channel = 0; channel < 2; ++channel)
+                    for (int i = 0; i < noise.getNumSamples(); ++i)
+                        noise.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+                reverb.process(noise);
+            }
+
+            reverb.reset();
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+            expectLessThan(maxErrorAgainstDirectConvolution(reverb, 1.0f), 1.0e-5);
+        }
+
+        beginTest("Callback cost per 32-sample block does not grow with the impulse length");
+        {
+            const auto shortImpulse = medianBlockMicroseconds(1.0f);
+            const auto longImpulse = medianBlockMicroseconds(5.0f);
+
+            logMessage("Median callback per 32-sample block at 48 kHz: "
+                       + juce::String(shortImpulse, 2) + " us with a 1.5 s impulse, "
+                       + juce::String(longImpulse, 2) + " us with a 7.5 s impulse");
+
+            // Loose bound: the long impulse moves 5x the work onto the worker, none onto the callback
+            expectLessThan(longImpulse, shortImpulse * 2.0 + 5.0);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int headBlockSize = 32;
+
+    static void prepare(ConvolutionReverb& reverb, float decaySeconds)
+    {
+        reverb.setMix(1.0f);
+        reverb.setDecay(decaySeconds);
+        reverb.prepare(sampleRate, 2, headBlockSize);
+    }
+
+    // Feeds a noise burst in random block sizes and compares the left channel with a direct convolution
+    double maxErrorAgainstDirectConvolution(ConvolutionReverb& reverb, float decaySeconds)
+    {
+        const auto impulse = ReverbImpulse::generate(decaySeconds, sampleRate, ConvolutionReverb::maxImpulseSeconds);
+        const int impulseLength = impulse.getNumSamples();
+        const float* h = impulse.getReadPointer(0);
+
+        constexpr int burstLength = 4000;
+        const int length = impulseLength + burstLength + headBlockSize;
+
+        auto random = getRandom();
+        std::vector<float> input(static_cast<size_t>(length), 0.0f), output(static_cast<size_t>(length));
+
+        for (int i = 0; i < burstLength; ++i)
+            input[static_cast<size_t>(i)] = random.nextFloat() * 2.0f - 1.0f;
+
+        juce::AudioBuffer<float> buffer(2, 1024);
+
+        for (int position = 0; position < length;)
+        {
+            const int blockSize = juce::jmin(1 + random.nextInt(1024), length - position);
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 2, blockSize);
+
+            for (int channel = 0; channel < 2; ++channel)
+                block.copyFrom(channel, 0, input.data() + position, blockSize);
+
+            reverb.process(block);
+            std::copy(block.getReadPointer(0), block.getReadPointer(0) + blockSize, output.data() + position);
+            position += blockSize;
+        }
+
+        double maxError = 0.0;
+
+        for (int i = 0; i < length; ++i)
+        {
+            double expected = 0.0;
+
+            for (int j = juce::jmax(0, i - headBlockSize - impulseLength + 1); j <= juce::jmin(i - headBlockSize, burstLength - 1); ++j)
+                expected += static_cast<double>(input[static_cast<size_t>(j)]) * h[i - headBlockSize - j];
+
+            maxError = juce::jmax(maxError, std::abs(expected - output[static_cast<size_t>(i)]));
+        }
+
+        return maxError;
+    }
+
+    // Runs 32-sample blocks paced in real time, so the worker competes as it would in a host
+    double medianBlockMicroseconds(float decaySeconds)
+    {
+        ConvolutionReverb reverb;
+        reverb.setMix(0.5f);
+        reverb.setDecay(decaySeconds);
+        reverb.prepare(sampleRate, 2, headBlockSize);
+
+        const int numBlocks = static_cast<int>(2.0 * sampleRate / headBlockSize);
+        juce::AudioBuffer<float> buffer(2, headBlockSize);
+        std::vector<double> durations;
+        durations.reserve(static_cast<size_t>(numBlocks));
+
+        auto random = getRandom();
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < headBlockSize; ++i)
+                    buffer.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            std::this_thread::sleep_until(start + std::chrono::microseconds(
+                static_cast<juce::int64>(block * headBlockSize * 1.0e6 / sampleRate)));
+
+            const auto before = std::chrono::steady_clock::now();
+            reverb.process(buffer);
+            durations.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count());
+        }
+
+        std::sort(durations.begin(), durations.end());
+        return durations[durations.size() / 2];
+    }
+};
+
+static ConvolutionReverbTests convolutionReverbTests;
@@ -0,0 +1,58 @@
+#include <JuceHeader.h>
+#include "../Source/Utility/MergedMidiEvents.h"
+
+class MergedMidiEventsTests : public juce::UnitTest
+{
+public:
+    MergedMidiEventsTests() : juce::UnitTest("MergedMidiEvents", "Utility") {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        for (int numHostEvents : { 0, 1, 16, 512 })
+        {
+            beginTest("Events come out as MidiBuffer::addEvents orders them, "
+                      + juce::String(numHostEvents) + " host events");
+
+            // Few distinct timestamps, so equal timestamps across the two buffers are common
+            juce::MidiBuffer host, sequencer;
+
+            for (int i = 0; i < numHostEvents; ++i)
+                host.addEvent(juce::MidiMessage::noteOn(1, 36 + i % 48, static_cast<juce::uint8>(1 + i % 127)),
+                              random.nextInt(64) * 8);
+
+            for (int i = 0; i < 8; ++i)
+                sequencer.addEvent(juce::MidiMessage::noteOn(2, 60 + i, static_cast<juce::uint8>(100)), i * 64);
+
+            juce::MidiBuffer combined;
+            combined.addEvents(host, 0, -1, 0);
+            combined.addEvents(sequencer, 0, -1, 0);
+
+            MergedMidiEvents merged(host, sequencer);
+            juce::MidiMessageMetadata event;
+            int numEvents = 0, numMismatches = 0;
+
+            for (const auto expected : combined)
+            {
+                if (!merged.next(event))
+                    break;
+
+                const bool sameEvent = event.samplePosition == expected.samplePosition
+                                    && event.numBytes == expected.numBytes
+                                    && std::equal(event.data, event.data + event.numBytes, expected.data);
+
+                if (!sameEvent)
+                    ++numMismatches;
+
+                ++numEvents;
+            }
+
+            expectEquals(numEvents, combined.getNumEvents());
+            expect(!merged.next(event), "merged stream has events left over");
+            expectEquals(numMismatches, 0);
+        }
+    }
+};
+
+static MergedMidiEventsTests mergedMidiEventsTests;
@@ -0,0 +1,113 @@
+#include <JuceHeader.h>
+#include "../Source/Sequencer/StepSequencer.h"
+
+class StepSequencerTests : public juce::UnitTest
+{
+public:
+    StepSequencerTests() : juce::UnitTest("StepSequencer clock", "Sequencer") {}
+
+    void runTest() override
+    {
+        beginTest("Steps land on the exact grid over hours of random block sizes");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr double bpm = 123.7;
+            const double samplesPerStep = sampleRate * 60.0 / bpm / 4.0;
+            const auto length = static_cast<juce::int64>(4 * 3600 * sampleRate);
+
+            StepSequencer sequencer;
+            sequencer.prepareToPlay(sampleRate, maxBlockSize);
+            sequencer.setTempo(bpm);
+            sequencer.setPlaying(true);
+
+            auto random = getRandom();
+            juce::int64 step = 0, maxDeviation = 0;
+
+            for (juce::int64 position = 0; position < length;)
+            {
+                const int blockSize = 1 + random.nextInt(maxBlockSize);
+
+                forEachNoteOn(sequencer, blockSize, [&] (int offset)
+                {
+                    const auto expected = firstSampleAtOrAfter(static_cast<double>(step) * samplesPerStep);
+                    maxDeviation = juce::jmax(maxDeviation, std::abs(position + offset - expected));
+                    ++step;
+                });
+
+                position += blockSize;
+            }
+
+            expectGreaterThan(step, static_cast<juce::int64>(length / samplesPerStep) - 1);
+            expectEquals(maxDeviation, static_cast<juce::int64>(0));
+        }
+
+        beginTest("A tempo change keeps the step in progress and re-anchors the grid");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr juce::int64 changeAt = 1000000;
+            const double samplesPerStepBefore = sampleRate * 60.0 / 120.0 / 4.0;
+            const double samplesPerStepAfter = sampleRate * 60.0 / 97.3 / 4.0;
+            const double stepsBeforeChange = static_cast<double>(changeAt) / samplesPerStepBefore;
+
+            StepSequencer sequencer;
+            sequencer.prepareToPlay(sampleRate, maxBlockSize);
+            sequencer.setTempo(120.0);
+            sequencer.setPlaying(true);
+
+            juce::Array<juce::int64> noteOns;
+
+            for (juce::int64 position = 0; position < 3 * changeAt;)
+            {
+                // The new tempo takes effect at the start of the block that begins at changeAt
+                if (position == changeAt)
+                    sequencer.setTempo(97.3);
+
+                const int blockSize = position < changeAt ? static_cast<int>(juce::jmin<juce::int64>(1000, changeAt - position))
+                                                          : 777;
+
+                forEachNoteOn(sequencer, blockSize, [&] (int offset) { noteOns.add(position + offset); });
+                position += blockSize;
+            }
+
+            int offGrid = 0;
+
+            for (int step = 0; step < noteOns.size(); ++step)
+            {
+                const auto expected = step <= static_cast<int>(std::floor(stepsBeforeChange))
+                    ? firstSampleAtOrAfter(step * samplesPerStepBefore)
+                    : changeAt + firstSampleAtOrAfter((step - stepsBeforeChange) * samplesPerStepAfter);
+
+                if (noteOns[step] != expected)
+                    ++offGrid;
+            }
+
+            expectGreaterThan(noteOns.size(), 0);
+            expectEquals(offGrid, 0);
+        }
+    }
+
+private:
+    static constexpr int maxBlockSize = 2048;
+
+    juce::AudioBuffer<float> buffer { 1, maxBlockSize };
+    juce::MidiBuffer midi;
+
+    static juce::int64 firstSampleAtOrAfter(double position)
+    {
+        return static_cast<juce::int64>(std::ceil(position - 1.0e-6));
+    }
+
+    template <typename Callback>
+    void forEachNoteOn(StepSequencer& sequencer, int blockSize, Callback&& callback)
+    {
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 1, blockSize);
+        midi.clear();
+        sequencer.processBlock(block, midi, nullptr);
+
+        for (const auto metadata : midi)
+            if (metadata.getMessage().isNoteOn())
+                callback(metadata.samplePosition);
+    }
+};
+
+static StepSequencerTests stepSequencerTests;
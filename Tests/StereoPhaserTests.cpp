@@ -0,0 +1,89 @@
+#include <JuceHeader.h>
+#include "../Source/Effects/StereoPhaser.h"
+
+class StereoPhaserTests : public juce::UnitTest
+{
+public:
+    StereoPhaserTests() : juce::UnitTest("StereoPhaser", "Effects") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr int numSamples = 4096;
+
+        juce::AudioBuffer<float> input(2, numSamples);
+        auto random = getRandom();
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                input.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        beginTest("With a static sweep the output matches dsp::Phaser");
+        {
+            // Depth 0 holds both phasers at the centre frequency, where their
+            // allpass coefficients are identical and only the filter structure is compared
+            StereoPhaser phaser;
+            phaser.setDepth(0.0f);
+            phaser.setFeedback(0.5f);
+            phaser.setMix(1.0f);
+            phaser.prepare(sampleRate, 2);
+
+            juce::dsp::Phaser<float> reference;
+            reference.setRate(1.0f);
+            reference.setDepth(0.0f);
+            reference.setCentreFrequency(1300.0f);
+            reference.setFeedback(0.5f);
+            reference.setMix(1.0f);
+            reference.prepare({ sampleRate, static_cast<juce::uint32>(numSamples), 2 });
+
+            juce::AudioBuffer<float> output;
+            output.makeCopyOf(input);
+            phaser.process(output);
+
+            juce::AudioBuffer<float> expected;
+            expected.makeCopyOf(input);
+            juce::dsp::AudioBlock<float> block(expected);
+            reference.process(juce::dsp::ProcessContextReplacing<float>(block));
+
+            expectLessThan(maxDifference(output, expected), 1.0e-4f);
+        }
+
+        beginTest("A mono buffer renders the left channel of a stereo one");
+        {
+            StereoPhaser stereo, mono;
+
+            for (auto* phaser : { &stereo, &mono })
+            {
+                phaser->setRate(2.0f);
+                phaser->setDepth(0.8f);
+                phaser->setFeedback(-0.6f);
+                phaser->setMix(0.5f);
+                phaser->prepare(sampleRate, 2);
+            }
+
+            juce::AudioBuffer<float> both, left(1, numSamples);
+            both.makeCopyOf(input);
+            left.copyFrom(0, 0, input, 0, 0, numSamples);
+
+            stereo.process(both);
+            mono.process(left);
+
+            both.setSize(1, numSamples, true);
+            expectLessThan(maxDifference(left, both), 1.0e-6f);
+        }
+    }
+
+private:
+    static float maxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float difference = 0.0f;
+
+        for (int channel = 0; channel < a.getNumChannels(); ++channel)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                difference = juce::jmax(difference, std::abs(a.getSample(channel, i) - b.getSample(channel, i)));
+
+        return difference;
+    }
+};
+
+static StereoPhaserTests stereoPhaserTests;
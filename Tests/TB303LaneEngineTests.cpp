@@ -0,0 +1,86 @@
+#include <JuceHeader.h>
+#include "../Source/Synth/TB303LaneEngine.h"
+
+class TB303LaneEngineTests : public juce::UnitTest
+{
+public:
+    TB303LaneEngineTests() : juce::UnitTest("TB303LaneEngine", "Synth") {}
+
+    void runTest() override
+    {
+        beginTest("Every lane renders what a voice of its own would");
+        {
+            // More lanes than one SIMD register holds, so a partly filled group is covered too
+            constexpr int numLanes = TB303LaneEngine::laneWidth + 1;
+            const float frequencies[] = { 55.0f, 65.4f, 82.4f, 110.0f, 130.8f, 164.8f, 220.0f, 261.6f, 329.6f };
+            static_assert(std::size(frequencies) >= numLanes, "one frequency per lane");
+
+            TB303LaneEngine layered;
+            prepare(layered, numLanes);
+
+            TB303LaneEngine singles[numLanes];
+            for (auto& single : singles)
+                prepare(single, 1);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                layered.noteOn(lane, frequencies[lane], lane % 2 == 0);
+                singles[lane].noteOn(0, frequencies[lane], lane % 2 == 0);
+            }
+
+            juce::HeapBlock<float> output(blockSize), single(blockSize), sum(blockSize);
+            float maxDifference = 0.0f, peak = 0.0f;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // Release the lanes at different times, so envelopes diverge between lanes
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    if (block == 10 + lane * 3)
+                    {
+                        layered.noteOff(lane);
+                        singles[lane].noteOff(0);
+                    }
+                }
+
+                layered.render(output, blockSize);
+                std::fill(sum.get(), sum.get() + blockSize, 0.0f);
+
+                for (auto& engine : singles)
+                {
+                    engine.render(single, blockSize);
+
+                    for (int i = 0; i < blockSize; ++i)
+                        sum[i] += single[i];
+                }
+
+                // The layered mix is scaled by 1 / sqrt(numLanes)
+                const float laneGain = 1.0f / std::sqrt(static_cast<float>(numLanes));
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    maxDifference = juce::jmax(maxDifference, std::abs(output[i] - sum[i] * laneGain));
+                    peak = juce::jmax(peak, std::abs(output[i]));
+                }
+            }
+
+            expectGreaterThan(peak, 0.01f);
+            expectLessThan(maxDifference, peak * 1.0e-5f);
+            expect(!layered.isAnyLaneActive());
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 44100.0;
+    static constexpr int blockSize = 256;
+    static constexpr int numBlocks = 400;
+
+    static void prepare(TB303LaneEngine& engine, int numLanes)
+    {
+        engine.prepare(sampleRate, blockSize);
+        engine.setNumLanes(numLanes);
+        engine.setParameters(800.0f, 0.6f, 0.3f, 0.5f, 0.3f, TB303LaneEngine::Shape::sawtooth);
+    }
+};
+
+static TB303LaneEngineTests laneEngineTests;
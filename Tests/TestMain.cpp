@@ -0,0 +1,16 @@
+#include <JuceHeader.h>
+
+// Runs every juce::UnitTest linked into this app; the exit code is non-zero if any check failed
+int main()
+{
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runAllTests();
+
+    int failures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}